@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Compare two popc-bench result files and flag regressions.
+
+Cases are matched by name. A case regresses when its time in CURRENT
+exceeds its time in BASELINE by more than the threshold; the exit status
+is 1 if any case regressed and 0 otherwise, so the script can gate CI.
+
+Usage: compare.py [--threshold FRACTION] [--metric FIELD] BASELINE CURRENT
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    """Return the results of a popc-bench file, keyed by case name."""
+    with open(path, encoding="utf-8") as f:
+        document = json.load(f)
+    return {result["name"]: result for result in document["results"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare two popc-bench result files and flag regressions."
+    )
+    parser.add_argument("baseline", help="results of the reference build")
+    parser.add_argument("current", help="results of the build under test")
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=0.10,
+        help="relative slowdown that counts as a regression (default 0.10)",
+    )
+    parser.add_argument(
+        "--metric",
+        choices=("median_seconds", "min_seconds"),
+        default="median_seconds",
+        help="timing to compare (default median_seconds)",
+    )
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = 0
+    width = max((len(name) for name in baseline.keys() | current.keys()), default=4)
+    print(f"{'case':<{width}}  {'baseline':>12}  {'current':>12}  {'ratio':>7}")
+    for name in sorted(baseline.keys() | current.keys()):
+        if name not in current:
+            print(f"{name:<{width}}  {'':>12}  {'':>12}  {'':>7}  missing from current")
+            continue
+        if name not in baseline:
+            print(f"{name:<{width}}  {'':>12}  {'':>12}  {'':>7}  new")
+            continue
+        before = baseline[name][args.metric]
+        after = current[name][args.metric]
+        ratio = after / before if before > 0 else float("inf")
+        verdict = ""
+        if ratio > 1 + args.threshold:
+            verdict = "REGRESSION"
+            regressions += 1
+        elif ratio < 1 / (1 + args.threshold):
+            verdict = "improved"
+        print(f"{name:<{width}}  {before:>12.6f}  {after:>12.6f}  {ratio:>7.3f}  {verdict}")
+
+    print(f"{regressions} regression(s) beyond {args.threshold:.0%}")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
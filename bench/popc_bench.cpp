@@ -0,0 +1,481 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <getopt.h>
+
+#include <popc/dataset.hpp>
+#include <popc/detail/bitpacked_kmeans.hpp>
+#include <popc/detail/power_table.hpp>
+#include <popc/partition.hpp>
+#include <popc/popc.hpp>
+
+#include "cli.hpp"
+
+#ifndef POPC_VERSION
+#define POPC_VERSION "unknown"
+#endif
+
+namespace {
+
+using popc::cli::parse_size;
+using popc::cli::short_usage;
+
+/** @brief Operand summary shown after the program name in usage text. */
+constexpr char const *synopsis = "[OPTION]...";
+
+/** @brief Seed of every generator in the suite, so runs are comparable. */
+constexpr std::uint64_t bench_seed = 20240611;
+
+/** @brief Candidate clusters scored per instance by the delta stage. */
+constexpr std::size_t delta_candidates = 64;
+
+/** @brief Number of planted prototypes the synthetic instances are drawn around. */
+constexpr std::size_t num_prototypes = 16;
+
+/** @brief Probability that an instance copies its prototype's bit rather than redrawing it. */
+constexpr double prototype_fidelity = 0.8;
+
+/**
+ * @brief Written by every timed body so the optimizer cannot discard its work.
+ *
+ * Assigned, never read; `volatile` keeps the stores.
+ */
+volatile std::size_t sink = 0;
+
+/** @brief One point of the benchmark grid. */
+struct grid_point {
+  std::size_t num_instances;
+  std::size_t num_attributes;
+  double density;
+  /** Seed cluster count; 0 for the stages that do not depend on it. */
+  std::size_t num_clusters;
+};
+
+/** @brief Timings of one stage at one grid point. */
+struct result {
+  std::string name;
+  char const *stage;
+  grid_point point;
+  /** Work items per repetition: instances, or compute_delta() calls. */
+  std::size_t items;
+  std::vector<double> seconds;
+};
+
+/** @brief Print the full `--help` usage text to stderr. */
+void usage(char const *program) {
+  std::cerr
+      << "Usage: " << program << ' ' << synopsis << '\n'
+      << "Time the stages of a POPC run on synthetic data and write the results as JSON.\n"
+      << "Stages are text parsing (parse), packing an in-memory matrix (pack), the\n"
+      << "bitpacked k-modes seed (seed), table-driven compute_delta() calls (delta), a full\n"
+      << "popc() refinement (refine) and writing the labels (output), each timed over a\n"
+      << "grid of instance counts, attribute counts, densities and seed cluster counts.\n"
+      << "Data is generated in-process from a fixed seed.\n\n"
+      << "  -o, --output=FILE       write the JSON results to FILE instead of standard\n"
+      << "                            output\n"
+      << "  -r, --repetitions=N     time every case N times (default 5) and report the\n"
+      << "                            minimum and median\n"
+      << "  -f, --filter=TEXT       run only the cases whose name contains TEXT\n"
+      << "  -q, --quick             use a small grid, for smoke tests\n"
+      << "  -h, --help              display this help and exit\n"
+      << "  -V, --version           output version information and exit\n\n"
+      << "Compare two result files with bench/compare.py.\n";
+}
+
+/**
+ * @brief Build the grid of `(n, F, density, K)` points.
+ *
+ * `K` runs over `n / 100` and `n / 10`; the CLI's own default of `n / 2`
+ * is dominated by the quadratic seed and would swamp the other stages.
+ */
+std::vector<grid_point> make_grid(bool quick) {
+  std::vector<std::size_t> const sizes = quick ? std::vector<std::size_t>{500}
+                                               : std::vector<std::size_t>{2000, 8000};
+  std::vector<std::size_t> const widths = quick ? std::vector<std::size_t>{64}
+                                                : std::vector<std::size_t>{64, 512};
+  std::vector<double> const densities = quick ? std::vector<double>{0.1}
+                                              : std::vector<double>{0.05, 0.25};
+  std::vector<grid_point> grid;
+  for (auto const n : sizes) {
+    for (auto const f : widths) {
+      for (auto const d : densities) {
+        grid.push_back({n, f, d, n / 100});
+        grid.push_back({n, f, d, n / 10});
+      }
+    }
+  }
+  return grid;
+}
+
+/**
+ * @brief Generate a row-major binary matrix with planted structure.
+ *
+ * Each instance is drawn around one of num_prototypes random prototypes:
+ * every bit copies the prototype's with probability prototype_fidelity and
+ * is redrawn otherwise, so the expected density is `density` throughout
+ * while the refinement still has clusters to find.
+ */
+std::vector<bool> generate(grid_point const &point) {
+  std::mt19937_64 rng{bench_seed};
+  std::bernoulli_distribution bit{point.density};
+  std::bernoulli_distribution keep{prototype_fidelity};
+  std::uniform_int_distribution<std::size_t> pick{0, num_prototypes - 1};
+
+  std::vector<bool> prototypes(num_prototypes * point.num_attributes);
+  for (std::size_t i = 0; i < prototypes.size(); ++i) {
+    prototypes[i] = bit(rng);
+  }
+  std::vector<bool> data(point.num_instances * point.num_attributes);
+  for (std::size_t i = 0; i < point.num_instances; ++i) {
+    std::size_t const proto = pick(rng);
+    for (std::size_t j = 0; j < point.num_attributes; ++j) {
+      data[i * point.num_attributes + j] =
+          keep(rng) ? static_cast<bool>(prototypes[proto * point.num_attributes + j]) : bit(rng);
+    }
+  }
+  return data;
+}
+
+/** @brief Render a generated matrix as the tab-separated text the CLI reads. */
+std::string to_text(std::vector<bool> const &data, grid_point const &point) {
+  std::string text;
+  text.reserve((point.num_instances + 1) * point.num_attributes * 2);
+  for (std::size_t j = 0; j < point.num_attributes; ++j) {
+    text += "attr" + std::to_string(j + 1);
+    text += j + 1 == point.num_attributes ? '\n' : '\t';
+  }
+  for (std::size_t i = 0; i < point.num_instances; ++i) {
+    for (std::size_t j = 0; j < point.num_attributes; ++j) {
+      text += data[i * point.num_attributes + j] ? '1' : '0';
+      text += j + 1 == point.num_attributes ? '\n' : '\t';
+    }
+  }
+  return text;
+}
+
+/**
+ * @brief Time `body` once per repetition, after an untimed `prepare`.
+ *
+ * @return Elapsed seconds of each repetition, in run order.
+ */
+template <typename Prepare, typename Body>
+std::vector<double> measure(std::size_t repetitions, Prepare &&prepare, Body &&body) {
+  std::vector<double> seconds;
+  seconds.reserve(repetitions);
+  for (std::size_t r = 0; r < repetitions; ++r) {
+    prepare();
+    auto const start = std::chrono::steady_clock::now();
+    body();
+    auto const stop = std::chrono::steady_clock::now();
+    seconds.push_back(std::chrono::duration<double>(stop - start).count());
+  }
+  return seconds;
+}
+
+/** @brief Return the name identifying a stage at a grid point across result files. */
+std::string case_name(char const *stage, grid_point const &point) {
+  std::ostringstream os;
+  os << stage << "/n=" << point.num_instances << "/F=" << point.num_attributes
+     << "/d=" << point.density;
+  if (point.num_clusters != 0) {
+    os << "/K=" << point.num_clusters;
+  }
+  return os.str();
+}
+
+/** @brief Return the smallest of `seconds`. */
+double minimum(std::vector<double> const &seconds) {
+  return *std::min_element(seconds.begin(), seconds.end());
+}
+
+/** @brief Return the median of `seconds`, the mean of the middle two for even sizes. */
+double median(std::vector<double> seconds) {
+  std::sort(seconds.begin(), seconds.end());
+  std::size_t const mid = seconds.size() / 2;
+  return seconds.size() % 2 == 1 ? seconds[mid] : (seconds[mid - 1] + seconds[mid]) / 2;
+}
+
+/** @brief Write the results as one JSON document. */
+void write_json(std::ostream &os, std::vector<result> const &results, std::size_t repetitions,
+                bool quick) {
+  auto const seconds = [&os](double value) -> std::ostream & {
+    return os << std::setprecision(std::numeric_limits<double>::max_digits10) << value
+              << std::setprecision(6);
+  };
+  os << "{\n"
+     << "  \"popc_version\": \"" << POPC_VERSION << "\",\n"
+     << "  \"repetitions\": " << repetitions << ",\n"
+     << "  \"quick\": " << (quick ? "true" : "false") << ",\n"
+     << "  \"results\": [";
+  for (std::size_t r = 0; r < results.size(); ++r) {
+    auto const &res = results[r];
+    double const med = median(res.seconds);
+    os << (r == 0 ? "\n" : ",\n") << "    {\"name\": \"" << res.name << "\", \"stage\": \""
+       << res.stage << "\", \"n\": " << res.point.num_instances
+       << ", \"features\": " << res.point.num_attributes << ", \"density\": " << res.point.density
+       << ", \"clusters\": " << res.point.num_clusters << ", \"items\": " << res.items
+       << ", \"min_seconds\": ";
+    seconds(minimum(res.seconds)) << ", \"median_seconds\": ";
+    seconds(med) << ", \"items_per_second\": "
+                 << (med > 0 ? static_cast<double>(res.items) / med : 0.0) << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+/** @brief Runs the stages over the grid and collects their results. */
+class suite {
+public:
+  suite(std::size_t repetitions, std::string filter)
+      : repetitions_{repetitions}, filter_{std::move(filter)} {}
+
+  /** @brief Run every stage at `point` that passes the filter. */
+  void run(grid_point const &point) {
+    grid_point const shape{point.num_instances, point.num_attributes, point.density, 0};
+    auto const data = generate(shape);
+    popc::dataset const ds{data, point.num_instances, point.num_attributes};
+
+    // Parsing and packing do not depend on the cluster count; time them
+    // for the first point of each shape only.
+    if (shape.num_instances != last_shape_.num_instances ||
+        shape.num_attributes != last_shape_.num_attributes ||
+        shape.density != last_shape_.density) {
+      last_shape_ = shape;
+      time_parse(shape, data);
+      time_pack(shape, data);
+    }
+
+    auto const labels = popc::detail::bitpacked_kmodes_seed(ds, point.num_clusters, 32, bench_seed);
+    time_seed(point, ds);
+    time_delta(point, ds);
+    auto const refined = time_refine(point, ds, labels);
+    time_output(point, refined);
+  }
+
+  /** @brief Return the collected results. */
+  [[nodiscard]] std::vector<result> const &results() const noexcept { return results_; }
+
+private:
+  /** @brief Return `true` if the case at `name` should run. */
+  [[nodiscard]] bool selected(std::string const &name) const {
+    return name.find(filter_) != std::string::npos;
+  }
+
+  /** @brief Time `body` as the case `stage` at `point` with `items` work items. */
+  template <typename Prepare, typename Body>
+  void time_case(char const *stage, grid_point const &point, std::size_t items,
+                 Prepare &&prepare, Body &&body) {
+    auto name = case_name(stage, point);
+    if (!selected(name)) {
+      return;
+    }
+    std::cerr << name << '\n';
+    auto seconds =
+        measure(repetitions_, std::forward<Prepare>(prepare), std::forward<Body>(body));
+    results_.push_back({std::move(name), stage, point, items, std::move(seconds)});
+  }
+
+  void time_parse(grid_point const &point, std::vector<bool> const &data) {
+    if (!selected(case_name("parse", point))) {
+      return;
+    }
+    auto const text = to_text(data, point);
+    time_case("parse", point, point.num_instances, [] {}, [&] {
+      popc::dataset const parsed{text};
+      sink = parsed.num_instances();
+    });
+  }
+
+  void time_pack(grid_point const &point, std::vector<bool> const &data) {
+    time_case("pack", point, point.num_instances, [] {}, [&] {
+      popc::dataset const packed{data, point.num_instances, point.num_attributes};
+      popc::detail::bitpacked_dataset const view{packed};
+      sink = view.words_per_instance();
+    });
+  }
+
+  void time_seed(grid_point const &point, popc::dataset const &ds) {
+    time_case("seed", point, point.num_instances, [] {}, [&] {
+      auto const labels =
+          popc::detail::bitpacked_kmodes_seed(ds, point.num_clusters, 32, bench_seed);
+      sink = labels.size();
+    });
+  }
+
+  /**
+   * @brief Time table-driven compute_delta() calls.
+   *
+   * The instances are dealt round-robin into `K` clusters, so every
+   * point scores the same number of candidates however the seed turned
+   * out. Each instance is scored for leaving its own cluster and for
+   * joining up to delta_candidates others, as one sweep's candidate scan
+   * would.
+   */
+  void time_delta(grid_point const &point, popc::dataset const &ds) {
+    std::vector<std::size_t> labels(ds.num_instances());
+    for (std::size_t i = 0; i < labels.size(); ++i) {
+      labels[i] = i % point.num_clusters;
+    }
+    popc::partition const part{ds, labels};
+    popc::detail::power_table<double> table{ds, 1000.0, 10.0};
+    table.set_num_clusters(part.num_clusters());
+    std::size_t const candidates = std::min(part.num_slots(), delta_candidates);
+    std::size_t calls = 0;
+    for (std::size_t i = 0; i < ds.num_instances(); ++i) {
+      calls += 1 + candidates - (part.slot_of(i) < candidates ? 1 : 0);
+    }
+    time_case("delta", point, calls, [] {}, [&] {
+      double total = 0;
+      for (std::size_t i = 0; i < ds.num_instances(); ++i) {
+        std::size_t const src = part.slot_of(i);
+        total += popc::compute_delta(ds, part.cluster(src), i, table, false);
+        for (std::size_t slot = 0; slot < candidates; ++slot) {
+          if (slot != src) {
+            total += popc::compute_delta(ds, part.cluster(slot), i, table, true);
+          }
+        }
+      }
+      sink = static_cast<std::size_t>(total != 0);
+    });
+  }
+
+  std::vector<std::size_t> time_refine(grid_point const &point, popc::dataset const &ds,
+                                       std::vector<std::size_t> const &labels) {
+    std::vector<std::size_t> refined;
+    popc::partition part;
+    time_case(
+        "refine", point, point.num_instances, [&] { part = popc::partition{ds, labels}; },
+        [&] {
+          refined = popc::popc(ds, part, popc::options<double>{});
+          sink = refined.size();
+        });
+    return refined.empty() ? labels : refined;
+  }
+
+  void time_output(grid_point const &point, std::vector<std::size_t> const &labels) {
+    std::ostringstream os;
+    time_case("output", point, labels.size(), [&] { os.str({}); }, [&] {
+      for (auto const label : labels) {
+        os << label << '\n';
+      }
+      sink = static_cast<std::size_t>(os.tellp());
+    });
+  }
+
+  std::size_t repetitions_;
+  std::string filter_;
+  grid_point last_shape_{};
+  std::vector<result> results_;
+};
+
+/**
+ * @brief Benchmark entry point separated from `main()` for exception safety.
+ *
+ * @return Process exit code: `0` on success, `1` on usage errors, `2` on
+ *         runtime errors.
+ */
+int run(int argc, char *argv[]) {
+  char const *output_file = nullptr;
+  std::size_t repetitions = 5;
+  std::string filter;
+  bool quick = false;
+
+  static option const long_options[] = {
+      {.name = "output", .has_arg = required_argument, .flag = nullptr, .val = 'o'},
+      {.name = "repetitions", .has_arg = required_argument, .flag = nullptr, .val = 'r'},
+      {.name = "filter", .has_arg = required_argument, .flag = nullptr, .val = 'f'},
+      {.name = "quick", .has_arg = no_argument, .flag = nullptr, .val = 'q'},
+      {.name = "help", .has_arg = no_argument, .flag = nullptr, .val = 'h'},
+      {.name = "version", .has_arg = no_argument, .flag = nullptr, .val = 'V'},
+      {.name = nullptr, .has_arg = 0, .flag = nullptr, .val = 0},
+  };
+
+  while (true) {
+    int option_index = 0;
+    int const c = getopt_long(argc, argv, "o:r:f:qhV", long_options, &option_index);
+    if (c == -1) {
+      break;
+    }
+    switch (c) {
+    case 'o':
+      output_file = optarg;
+      break;
+    case 'r':
+      if (!parse_size(optarg, repetitions) || repetitions == 0) {
+        std::cerr << argv[0] << ": -r, --repetitions=N must be a positive integer\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 'f':
+      filter = optarg;
+      break;
+    case 'q':
+      quick = true;
+      break;
+    case 'h':
+      usage(argv[0]);
+      return 0;
+    case 'V':
+      std::cout << "popc-bench v" << POPC_VERSION << "\n";
+      return 0;
+    default:
+      short_usage(argv[0], synopsis);
+      return 1;
+    }
+  }
+  if (optind != argc) {
+    std::cerr << argv[0] << ": unexpected argument: " << argv[optind] << "\n";
+    short_usage(argv[0], synopsis);
+    return 1;
+  }
+
+  std::ofstream file_out;
+  if (output_file != nullptr) {
+    file_out.open(output_file);
+    if (!file_out.is_open()) {
+      std::cerr << argv[0] << ": cannot open output file: " << output_file << "\n";
+      return 2;
+    }
+  }
+
+  suite bench{repetitions, std::move(filter)};
+  for (auto const &point : make_grid(quick)) {
+    bench.run(point);
+  }
+  std::ostream &out = output_file != nullptr ? file_out : std::cout;
+  write_json(out, bench.results(), repetitions, quick);
+  out.flush();
+  if (!out) {
+    std::cerr << argv[0] << ": error writing results\n";
+    return 2;
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  try {
+    return run(argc, argv);
+  } catch (std::exception const &e) {
+    std::cerr << argv[0] << ": " << e.what() << "\n";
+    return 2;
+  } catch (...) {
+    std::cerr << argv[0] << ": unknown error\n";
+    return 2;
+  }
+}
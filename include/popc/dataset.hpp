@@ -1,42 +1,137 @@
 #ifndef POPC_DATASET_HPP
 #define POPC_DATASET_HPP
 
+#include <algorithm>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <iosfwd>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "detail/binary_format.hpp"
+#include "detail/mapped_file.hpp"
+#include "detail/row_decoder.hpp"
+#include "detail/thread_pool.hpp"
+
 namespace popc {
 
+/** @brief Tag type selecting the binary-file constructors of popc::dataset. */
+struct binary_format_t {
+  explicit binary_format_t() = default;
+};
+
+/** @brief Tag value selecting the binary-file constructors of popc::dataset. */
+inline constexpr binary_format_t binary_format{};
+
 /**
  * @brief Binary feature dataset with named attribute columns.
  *
- * Stores `num_instances * num_attributes` boolean values in row-major order
- * inside a flat `std::vector<bool>`, plus the attribute names parsed from
- * the input header and a per-attribute positive-count cache. The positive
+ * Stores `num_instances * num_attributes` boolean values in row-major order,
+ * bitpacked into 64-bit words: each instance occupies `words_per_instance()`
+ * contiguous words, bit `j % 64` of word `j / 64` holding attribute `j`.
+ * Padding bits in the trailing word of every instance are zero. Alongside
+ * the bits it keeps the attribute names parsed from the input header and a
+ * per-attribute positive-count cache. The positive
  * counts are precomputed at construction so popc::compute_delta() can use
  * them as the `c(f_i = 1)` term of the probability formula without a full
  * scan on every call.
  *
- * Used as the input to popc::popc() and as the source the bitpacked seeder
- * (popc::detail::bitpacked_kmodes_seed) repacks into 64-bit chunks for its
- * popcount distance kernel.
+ * Alongside the dense storage, a CSR-style index lists the set attribute
+ * columns of every instance in ascending order. Only set attributes
+ * contribute to popc::compute_delta(), so the refinement loop walks this
+ * index and its cost scales with the number of set bits rather than with
+ * `num_attributes()`. Attribute indices are stored as 32-bit integers to
+ * keep the index compact on sparse inputs.
+ *
+ * The storage is immutable once constructed and shared between copies.
+ * It is either owned by the dataset (text parsers, data-vector
+ * constructor) or viewed in place inside a memory-mapped binary file
+ * written by write_binary(), which makes loading a binary dataset a
+ * matter of validating its header.
+ *
+ * Used as the input to popc::popc() and, through the non-owning
+ * popc::detail::bitpacked_dataset view, as the input of the popcount
+ * distance kernel in popc::detail::bitpacked_kmodes_seed(). Both read the
+ * same word storage; nothing is repacked.
  */
 class dataset {
   friend std::ostream &operator<<(std::ostream &os, dataset const &ds);
 
 public:
   using value_type = bool;
+  using size_type = std::size_t;
+  using index_type = std::uint32_t;
+  using word_type = std::uint64_t;
 
-private:
-  using storage_type = std::vector<value_type>;
+  /** @brief Number of attribute bits held by one storage word. */
+  static constexpr size_type bits_per_word = 64;
 
-public:
-  using size_type = std::size_t;
-  using const_iterator = storage_type::const_iterator;
+  /**
+   * @brief Read-only forward iterator over the attribute bits of an instance.
+   *
+   * Dereferences to the `bool` value of the current attribute. Produced by
+   * cbegin() / cend(); the word storage must outlive the iterator.
+   */
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = bool;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = bool;
+
+    /** @brief Construct a singular iterator. */
+    const_iterator() = default;
+
+    /**
+     * @brief Construct an iterator at a given bit of a word array.
+     *
+     * @param words Pointer to the first word of the instance.
+     * @param bit   Zero-based bit offset from `words`.
+     */
+    const_iterator(word_type const *words, size_type bit) noexcept : words_{words}, bit_{bit} {}
+
+    /** @brief Return the value of the current attribute bit. */
+    [[nodiscard]] bool operator*() const noexcept {
+      return ((words_[bit_ / bits_per_word] >> (bit_ % bits_per_word)) & word_type{1}) != 0U;
+    }
+
+    /** @brief Advance to the next attribute. */
+    const_iterator &operator++() noexcept {
+      ++bit_;
+      return *this;
+    }
+
+    /** @brief Advance to the next attribute, returning the prior position. */
+    const_iterator operator++(int) noexcept {
+      auto const tmp = *this;
+      ++bit_;
+      return tmp;
+    }
+
+    /** @brief Return `true` if both iterators point at the same bit. */
+    [[nodiscard]] friend bool operator==(const_iterator const &a,
+                                         const_iterator const &b) noexcept {
+      return a.words_ + a.bit_ / bits_per_word == b.words_ + b.bit_ / bits_per_word &&
+             a.bit_ % bits_per_word == b.bit_ % bits_per_word;
+    }
+
+  private:
+    word_type const *words_{};
+    size_type bit_{};
+  };
 
   /** @brief Construct an empty dataset with no instances or attributes. */
   dataset() = default;
@@ -54,17 +149,46 @@ public:
    * @param delimiter Column separator. Defaults to TAB (`'\t'`).
    *
    * @throws std::runtime_error if the input is not a valid header followed
-   *         by zero or more binary rows.
+   *         by zero or more binary rows, or if the header names more
+   *         attributes than `index_type` can address.
    */
   explicit dataset(std::istream &is, char delimiter = '\t');
 
   /**
-   * @brief Construct directly from a pre-built storage vector.
+   * @brief Parse a dataset from an in-memory delimited text buffer.
+   *
+   * Accepts the same grammar as the stream constructor and reports the
+   * same errors, but scans the buffer directly instead of issuing one
+   * stream call per character. Intended for memory-mapped input files
+   * (see popc::detail::mapped_file); the buffer is only read during
+   * construction and need not outlive the dataset.
+   *
+   * With `num_threads > 1` and a large enough buffer, the rows are split
+   * at newline boundaries into one chunk per thread and the chunks are
+   * parsed concurrently into per-chunk buffers, which are then
+   * concatenated in input order and their positive counts summed. The
+   * result, including the line number of any error, is identical to a
+   * single-threaded parse.
+   *
+   * @param buffer      Complete input: header line followed by the rows.
+   * @param delimiter   Column separator. Defaults to TAB (`'\t'`).
+   * @param num_threads Number of parsing threads. Defaults to 1; 0 is
+   *                    treated as 1.
+   *
+   * @throws std::runtime_error if the input is not a valid header followed
+   *         by zero or more binary rows, or if the header names more
+   *         attributes than `index_type` can address.
+   */
+  explicit dataset(std::string_view buffer, char delimiter = '\t', size_type num_threads = 1);
+
+  /**
+   * @brief Construct directly from a pre-built row-major bool vector.
    *
    * Intended for language bindings and unit tests that already have the
    * data in memory and do not need to round-trip through the text parser.
-   * If `names` is empty, generic names of the form `"attr1"`, `"attr2"`,
-   * ... are generated. The positive-count cache is computed eagerly.
+   * The values are packed into the word storage. If `names` is empty,
+   * generic names of the form `"attr1"`, `"attr2"`, ... are generated. The
+   * positive-count cache is computed eagerly.
    *
    * @param data           Row-major storage of `num_instances * num_attributes` bools.
    * @param num_instances  Row count of the dataset.
@@ -73,10 +197,75 @@ public:
    *                       size equal to `num_attributes`.
    *
    * @throws std::logic_error if `data.size() != num_instances * num_attributes`,
-   *         or if `names` is non-empty and `names.size() != num_attributes`.
+   *         if `names` is non-empty and `names.size() != num_attributes`, or
+   *         if `num_attributes` does not fit in `index_type`.
+   */
+  dataset(std::vector<value_type> const &data, size_type num_instances,
+          size_type num_attributes, std::vector<std::string> names = {});
+
+  /**
+   * @brief Load a dataset from a memory-mapped binary file.
+   *
+   * The file must have been produced by write_binary(). Only the header
+   * and the name table are read and validated; the row words, positive
+   * counts and (if present) set-attribute index are used in place, so
+   * loading takes time proportional to `num_attributes()` rather than to
+   * the data size. The mapping is kept alive for as long as any copy of
+   * the dataset exists. A file written without the index gets one built
+   * from the row words on load.
+   *
+   * The row data is trusted beyond the structural checks: a file whose
+   * sections are the right size but whose contents were altered by hand
+   * (non-zero padding bits, out-of-range indices) gives unspecified
+   * results.
+   *
+   * @param tag  popc::binary_format.
+   * @param file Mapping of the binary file.
+   *
+   * @throws std::runtime_error if the file is not a binary dataset, was
+   *         written on a host with a different byte order or by an
+   *         unsupported format version, or is truncated or inconsistent.
    */
-  dataset(storage_type data, size_type num_instances, size_type num_attributes,
-          std::vector<std::string> names = {});
+  dataset(binary_format_t tag, detail::mapped_file file);
+
+  /**
+   * @brief Map and load the binary dataset file at `path`.
+   *
+   * @param tag  popc::binary_format.
+   * @param path Path to a regular file produced by write_binary().
+   *
+   * @throws std::system_error if the file cannot be mapped.
+   * @throws std::runtime_error as for the mapped_file overload.
+   */
+  dataset(binary_format_t tag, std::filesystem::path const &path)
+      : dataset{tag, detail::mapped_file{path.c_str()}} {}
+
+  /**
+   * @brief Return `true` if `bytes` begins with the binary dataset magic.
+   *
+   * Lets a caller that has already mapped a file decide between the text
+   * and binary constructors.
+   */
+  [[nodiscard]] static bool is_binary(std::string_view bytes) noexcept {
+    return bytes.size() >= detail::binary_magic.size() &&
+           std::memcmp(bytes.data(), detail::binary_magic.data(), detail::binary_magic.size()) ==
+               0;
+  }
+
+  /**
+   * @brief Serialize the dataset in the binary format.
+   *
+   * The output can be loaded with the binary_format constructors; see
+   * popc::detail::binary_header for the layout. Integers are written in
+   * the host byte order.
+   *
+   * @param os            Stream opened in binary mode.
+   * @param include_index Also write the set-attribute index, so that
+   *                      loading needs no pass over the row words.
+   *
+   * @throws std::runtime_error if writing to `os` fails.
+   */
+  void write_binary(std::ostream &os, bool include_index = true) const;
 
   /** @brief Return the number of instances (rows) in the dataset. */
   [[nodiscard]] size_type num_instances() const noexcept { return num_instances_; }
@@ -84,6 +273,9 @@ public:
   /** @brief Return the number of attributes (columns) in the dataset. */
   [[nodiscard]] size_type num_attributes() const noexcept { return names_.size(); }
 
+  /** @brief Return the number of 64-bit words used to store one instance. */
+  [[nodiscard]] size_type words_per_instance() const noexcept { return words_per_instance_; }
+
   /**
    * @brief Read the value at a given instance and attribute.
    *
@@ -93,7 +285,20 @@ public:
    */
   [[nodiscard]] value_type operator()(size_type instance_num,
                                       size_type attribute_num) const noexcept {
-    return data_[instance_num * num_attributes() + attribute_num];
+    return ((data_[instance_num * words_per_instance_ + attribute_num / bits_per_word] >>
+             (attribute_num % bits_per_word)) &
+            word_type{1}) != 0U;
+  }
+
+  /**
+   * @brief Return the packed words of one instance.
+   *
+   * @param instance_num Zero-based row index in `[0, num_instances())`.
+   * @return Span of `words_per_instance()` words; trailing padding bits
+   *         are zero.
+   */
+  [[nodiscard]] std::span<word_type const> words(size_type instance_num) const noexcept {
+    return {data_.data() + instance_num * words_per_instance_, words_per_instance_};
   }
 
   /**
@@ -117,6 +322,19 @@ public:
     return positive_counts_[attribute_num];
   }
 
+  /**
+   * @brief Return the ascending list of set attribute columns of an instance.
+   *
+   * @param instance_num Zero-based row index in `[0, num_instances())`.
+   * @return Span over the indices of the attributes that are `true` in
+   *         `instance_num`, in increasing column order.
+   */
+  [[nodiscard]] std::span<index_type const>
+  positive_attributes(size_type instance_num) const noexcept {
+    return {positive_attributes_.data() + row_offsets_[instance_num],
+            positive_attributes_.data() + row_offsets_[instance_num + 1]};
+  }
+
   /**
    * @brief Return a const iterator to the first attribute of an instance.
    *
@@ -124,7 +342,7 @@ public:
    * @return Iterator pointing at the first column of `instance_num`.
    */
   [[nodiscard]] const_iterator cbegin(size_type instance_num) const noexcept {
-    return data_.cbegin() + static_cast<std::ptrdiff_t>(instance_num * num_attributes());
+    return {data_.data() + instance_num * words_per_instance_, 0};
   }
 
   /**
@@ -134,85 +352,328 @@ public:
    * @return Iterator pointing one past the last column of `instance_num`.
    */
   [[nodiscard]] const_iterator cend(size_type instance_num) const noexcept {
-    return data_.cbegin() + static_cast<std::ptrdiff_t>((instance_num + 1) * num_attributes());
+    return {data_.data() + instance_num * words_per_instance_, num_attributes()};
   }
 
 private:
+  /**
+   * @brief Split the header line into attribute names and size the storage.
+   *
+   * @throws std::runtime_error if there are more names than `index_type`
+   *         can address, or if the input is a binary dataset.
+   */
+  void parse_header(std::string_view header, char delimiter);
+
+  /** @brief Rows parsed from one contiguous slice of the input, or owned storage. */
+  struct row_block {
+    explicit row_block(size_type num_attributes) : positive_counts(num_attributes, 0) {}
+
+    std::vector<word_type> data;
+    std::vector<size_type> positive_counts;
+    std::vector<size_type> row_offsets{0};
+    std::vector<index_type> positive_attributes;
+    size_type num_rows{};
+  };
+
+  /**
+   * @brief Parse complete rows from `[first, last)` and append them to `out`.
+   *
+   * Shared by both parsing constructors. Rows go through the vectorized
+   * popc::detail::decode_row() fast path; a row it rejects is re-parsed
+   * byte by byte to report a precise error. Reads only the header-derived
+   * members, so distinct blocks can be filled concurrently.
+   *
+   * @param out        Block receiving the rows.
+   * @param first      First byte of the next row.
+   * @param last       One past the last available byte.
+   * @param delimiter  Column separator.
+   * @param first_line Input line number of the first row of `out`, used
+   *                   in error messages.
+   * @param final      `true` if no more input follows `last`. When
+   *                   `false`, parsing stops before a trailing partial row.
+   * @return Pointer to the first unconsumed byte (`last` when `final`).
+   *
+   * @throws std::runtime_error on the first malformed row.
+   */
+  char const *parse_rows(row_block &out, char const *first, char const *last, char delimiter,
+                         size_type first_line, bool final) const;
+
+  /** @brief Take over the rows of a block as the dataset's storage. */
+  void adopt(row_block &&block);
+
+  /** @brief Owner of a memory-mapped binary file and any index built on load. */
+  struct mapped_storage {
+    detail::mapped_file file;
+    std::vector<size_type> row_offsets;
+    std::vector<index_type> positive_attributes;
+  };
+
   std::vector<std::string> names_;
-  storage_type data_;
+  size_type words_per_instance_{};
   size_type num_instances_{};
-  std::vector<size_type> positive_counts_;
+  // Keeps the views below alive: a row_block or a mapped_storage.
+  std::shared_ptr<void const> storage_;
+  std::span<word_type const> data_;
+  std::span<size_type const> positive_counts_;
+  std::span<size_type const> row_offsets_;
+  std::span<index_type const> positive_attributes_;
 };
 
 inline dataset::dataset(std::istream &is, char delimiter) {
-  // Header line: delimiter-separated names, terminated by newline.
-  std::string name;
-  while (!is.eof()) {
-    char const c = static_cast<char>(is.get());
-    if (c == delimiter) {
-      names_.emplace_back(std::move(name));
-      name.clear();
-    } else if (c == '\n') {
-      names_.emplace_back(std::move(name));
+  std::string header;
+  if (!std::getline(is, header)) {
+    return;
+  }
+  parse_header(header, delimiter);
+  if (is.eof()) {
+    adopt(row_block{num_attributes()});
+    return;
+  }
+
+  // Body: read in large blocks and hand every complete row to the shared
+  // row parser; an incomplete trailing row is carried over to the next
+  // block. The block is always large enough to hold at least one row.
+  std::size_t const block_size = std::max<std::size_t>(std::size_t{1} << 20U,
+                                                       2 * num_attributes());
+  std::string buffer;
+  row_block rows{num_attributes()};
+  std::size_t carry = 0;
+  while (true) {
+    buffer.resize(carry + block_size);
+    is.read(buffer.data() + carry, static_cast<std::streamsize>(block_size));
+    auto const got = static_cast<std::size_t>(is.gcount());
+    bool const final = got < block_size;
+    char const *const first = buffer.data();
+    char const *const last = first + carry + got;
+    char const *const rest = parse_rows(rows, first, last, delimiter, 2, final);
+    carry = static_cast<std::size_t>(last - rest);
+    if (rest != first) {
+      std::copy(rest, last, buffer.data());
+    }
+    if (final) {
       break;
-    } else {
-      name.push_back(c);
     }
-    is.peek();
   }
+  rows.data.shrink_to_fit();
+  rows.positive_attributes.shrink_to_fit();
+  adopt(std::move(rows));
+}
+
+inline dataset::dataset(std::string_view buffer, char delimiter, size_type num_threads) {
+  auto const header_end = buffer.find('\n');
+  if (buffer.empty()) {
+    return;
+  }
+  parse_header(buffer.substr(0, header_end), delimiter);
+  if (header_end == std::string_view::npos) {
+    adopt(row_block{num_attributes()});
+    return;
+  }
+
+  // Every well-formed row is exactly 2 * num_attributes() bytes, which
+  // gives a tight reservation for the row storage. Chunks smaller than
+  // min_chunk_bytes are not worth a thread.
+  constexpr size_type min_chunk_bytes = size_type{1} << 20U;
+  char const *const first = buffer.data() + header_end + 1;
+  char const *const last = buffer.data() + buffer.size();
+  auto const body_bytes = static_cast<size_type>(last - first);
+  size_type const row_bytes = 2 * num_attributes();
+  size_type const num_chunks =
+      std::clamp<size_type>(body_bytes / min_chunk_bytes, 1, std::max<size_type>(num_threads, 1));
+  auto const reserve = [&](row_block &block, size_type bytes) {
+    block.data.reserve(bytes / row_bytes * words_per_instance_);
+    block.row_offsets.reserve(bytes / row_bytes + 1);
+  };
 
-  // Body: one binary value per column, delimiter-separated, newline-terminated.
-  data_.reserve(256 * num_attributes());
-  positive_counts_.resize(num_attributes());
-  size_type instance_num = 0;
-  size_type attribute_num = 0;
-  while (!is.eof()) {
-    if (attribute_num == 0) {
-      ++num_instances_;
+  if (num_chunks == 1) {
+    row_block rows{num_attributes()};
+    reserve(rows, body_bytes);
+    parse_rows(rows, first, last, delimiter, 2, /*final=*/true);
+    rows.positive_attributes.shrink_to_fit();
+    adopt(std::move(rows));
+    return;
+  }
+
+  // Split the body into num_chunks slices that each end just after a
+  // newline (the last one at the end of the buffer), so no row straddles
+  // two slices.
+  std::vector<char const *> bounds{first};
+  for (size_type k = 1; k < num_chunks; ++k) {
+    char const *const target = std::max(first + body_bytes / num_chunks * k, bounds.back());
+    char const *const newline = std::find(target, last, '\n');
+    bounds.push_back(newline == last ? last : newline + 1);
+  }
+  bounds.push_back(last);
+
+  // Chunks do not know their starting line until the earlier ones are
+  // parsed, so a chunk that fails only records the failure. The first
+  // failing chunk is then re-parsed with its true starting line, which
+  // reproduces the single-threaded error message exactly: every earlier
+  // chunk parsed cleanly, so their row counts are final.
+  std::vector<row_block> blocks(num_chunks, row_block{num_attributes()});
+  std::vector<char> failed(num_chunks, 0);
+  detail::thread_pool pool{num_chunks};
+  pool.for_each(num_chunks, [&](size_type k) {
+    reserve(blocks[k], static_cast<size_type>(bounds[k + 1] - bounds[k]));
+    try {
+      parse_rows(blocks[k], bounds[k], bounds[k + 1], delimiter, 0, /*final=*/true);
+    } catch (std::runtime_error const &) {
+      failed[k] = 1;
     }
-    char c = static_cast<char>(is.get());
-    if (c == '0') {
-      data_.push_back(false);
-    } else if (c == '1') {
-      data_.push_back(true);
-      ++positive_counts_[attribute_num];
-    } else if (c == delimiter) {
-      throw std::runtime_error{"unexpected delimiter at line " + std::to_string(instance_num + 2)};
-    } else if (c == '\n') {
-      throw std::runtime_error{"newline after delimiter at line " +
-                               std::to_string(instance_num + 2)};
-    } else {
-      throw std::runtime_error{"invalid character for attribute value at line " +
-                               std::to_string(instance_num + 2) + " column " +
-                               std::to_string(attribute_num + 1) + " (must be 0 or 1)"};
+  });
+  std::vector<size_type> row_base(num_chunks + 1, 0);
+  std::vector<size_type> nnz_base(num_chunks + 1, 0);
+  for (size_type k = 0; k < num_chunks; ++k) {
+    if (failed[k] != 0) {
+      row_block scratch{num_attributes()};
+      parse_rows(scratch, bounds[k], bounds[k + 1], delimiter, 2 + row_base[k], true);
     }
-    c = static_cast<char>(is.get());
-    if (c == delimiter) {
-      ++attribute_num;
-    } else if (c == '\n') {
-      if (attribute_num + 1 == num_attributes()) {
-        attribute_num = 0;
-        ++instance_num;
-      } else {
-        throw std::runtime_error{"inconsistent column count at line " +
-                                 std::to_string(instance_num + 2)};
+    row_base[k + 1] = row_base[k] + blocks[k].num_rows;
+    nnz_base[k + 1] = nnz_base[k] + blocks[k].positive_attributes.size();
+  }
+
+  // Concatenate the blocks in input order (each thread copies its own
+  // block into place) and reduce the per-chunk positive counts.
+  row_block merged{num_attributes()};
+  merged.num_rows = row_base.back();
+  merged.data.resize(merged.num_rows * words_per_instance_);
+  merged.row_offsets.resize(merged.num_rows + 1);
+  merged.positive_attributes.resize(nnz_base.back());
+  pool.for_each(num_chunks, [&](size_type k) {
+    row_block &block = blocks[k];
+    std::ranges::copy(block.data, merged.data.begin() + static_cast<std::ptrdiff_t>(
+                                                            row_base[k] * words_per_instance_));
+    std::ranges::copy(block.positive_attributes, merged.positive_attributes.begin() +
+                                                     static_cast<std::ptrdiff_t>(nnz_base[k]));
+    for (size_type r = 1; r <= block.num_rows; ++r) {
+      merged.row_offsets[row_base[k] + r] = nnz_base[k] + block.row_offsets[r];
+    }
+    block.data = {};
+    block.positive_attributes = {};
+  });
+  for (auto const &block : blocks) {
+    for (size_type j = 0; j < num_attributes(); ++j) {
+      merged.positive_counts[j] += block.positive_counts[j];
+    }
+  }
+  adopt(std::move(merged));
+}
+
+inline void dataset::parse_header(std::string_view header, char delimiter) {
+  if (is_binary(header)) {
+    throw std::runtime_error{"input is a binary dataset, which must be loaded from a regular file"};
+  }
+  while (true) {
+    auto const pos = header.find(delimiter);
+    names_.emplace_back(header.substr(0, pos));
+    if (pos == std::string_view::npos) {
+      break;
+    }
+    header.remove_prefix(pos + 1);
+  }
+  if (num_attributes() > std::numeric_limits<index_type>::max()) {
+    throw std::runtime_error{"too many attributes in header"};
+  }
+  words_per_instance_ = (num_attributes() + bits_per_word - 1) / bits_per_word;
+}
+
+inline char const *dataset::parse_rows(row_block &out, char const *p, char const *last,
+                                       char delimiter, size_type first_line, bool final) const {
+  size_type const num_attributes = this->num_attributes();
+  size_type const row_bytes = 2 * num_attributes;
+  while (p != last) {
+    if (!final && static_cast<size_type>(last - p) < row_bytes) {
+      return p;
+    }
+    size_type const line = first_line + out.num_rows;
+    out.data.resize(out.data.size() + words_per_instance_, word_type{0});
+    word_type *const row = out.data.data() + out.num_rows * words_per_instance_;
+
+    if (static_cast<size_type>(last - p) >= row_bytes &&
+        detail::decode_row(p, num_attributes, delimiter, row)) {
+      // Fast path: the vector decoder validated and packed the row;
+      // derive the positive counts and the set-attribute index from it.
+      for (size_type w = 0; w < words_per_instance_; ++w) {
+        for (word_type word = row[w]; word != 0U; word &= word - 1) {
+          auto const j = w * bits_per_word + static_cast<size_type>(std::countr_zero(word));
+          ++out.positive_counts[j];
+          out.positive_attributes.push_back(static_cast<index_type>(j));
+        }
       }
+      p += row_bytes;
     } else {
-      throw std::runtime_error{std::string{"invalid character '"} + c + "' at line " +
-                               std::to_string(instance_num + 2)};
+      // Malformed or truncated row: re-parse byte by byte to find and
+      // report the exact error. A row that turns out well formed here
+      // (only possible if the fast path is conservative) is accepted.
+      std::fill_n(row, words_per_instance_, word_type{0});
+      size_type const row_start = out.positive_attributes.size();
+      for (size_type attribute_num = 0;; ++attribute_num) {
+        char const v = p != last ? *p++ : '\0';
+        if (v == '1') {
+          row[attribute_num / bits_per_word] |= word_type{1} << (attribute_num % bits_per_word);
+          out.positive_attributes.push_back(static_cast<index_type>(attribute_num));
+        } else if (v == delimiter) {
+          throw std::runtime_error{"unexpected delimiter at line " +
+                                   std::to_string(line)};
+        } else if (v == '\n') {
+          throw std::runtime_error{"newline after delimiter at line " +
+                                   std::to_string(line)};
+        } else if (v != '0') {
+          throw std::runtime_error{"invalid character for attribute value at line " +
+                                   std::to_string(line) + " column " +
+                                   std::to_string(attribute_num + 1) + " (must be 0 or 1)"};
+        }
+        if (p == last) {
+          throw std::runtime_error{"unexpected end of input at line " +
+                                   std::to_string(line)};
+        }
+        char const sep = *p++;
+        if (sep == delimiter) {
+          if (attribute_num + 1 == num_attributes) {
+            throw std::runtime_error{"inconsistent column count at line " +
+                                     std::to_string(line)};
+          }
+        } else if (sep == '\n') {
+          if (attribute_num + 1 != num_attributes) {
+            throw std::runtime_error{"inconsistent column count at line " +
+                                     std::to_string(line)};
+          }
+          break;
+        } else {
+          throw std::runtime_error{std::string{"invalid character '"} + sep + "' at line " +
+                                   std::to_string(line)};
+        }
+      }
+      for (size_type k = row_start; k < out.positive_attributes.size(); ++k) {
+        ++out.positive_counts[out.positive_attributes[k]];
+      }
     }
-    is.peek();
+    ++out.num_rows;
+    out.row_offsets.push_back(out.positive_attributes.size());
   }
-  data_.shrink_to_fit();
+  return p;
 }
 
-inline dataset::dataset(storage_type data, size_type num_instances, size_type num_attributes,
-                        std::vector<std::string> names)
-    : names_{std::move(names)}, data_{std::move(data)}, num_instances_{num_instances},
-      positive_counts_(num_attributes, 0) {
-  if (num_instances * num_attributes != data_.size()) {
+inline void dataset::adopt(row_block &&block) {
+  auto owned = std::make_shared<row_block const>(std::move(block));
+  num_instances_ = owned->num_rows;
+  data_ = owned->data;
+  positive_counts_ = owned->positive_counts;
+  row_offsets_ = owned->row_offsets;
+  positive_attributes_ = owned->positive_attributes;
+  storage_ = std::move(owned);
+}
+
+inline dataset::dataset(std::vector<value_type> const &data, size_type num_instances,
+                        size_type num_attributes, std::vector<std::string> names)
+    : names_{std::move(names)},
+      words_per_instance_{(num_attributes + bits_per_word - 1) / bits_per_word} {
+  if (num_instances * num_attributes != data.size()) {
     throw std::logic_error{"data size must equal num_instances * num_attributes"};
   }
+  if (num_attributes > std::numeric_limits<index_type>::max()) {
+    throw std::logic_error{"num_attributes must fit in index_type"};
+  }
   if (names_.empty()) {
     for (size_type i = 0; i < num_attributes; ++i) {
       names_.emplace_back("attr" + std::to_string(i + 1));
@@ -220,12 +681,146 @@ inline dataset::dataset(storage_type data, size_type num_instances, size_type nu
   } else if (num_attributes != names_.size()) {
     throw std::logic_error{"names size must equal num_attributes or be zero"};
   }
+  row_block rows{num_attributes};
+  rows.num_rows = num_instances;
+  rows.data.assign(num_instances * words_per_instance_, word_type{0});
+  rows.row_offsets.reserve(num_instances + 1);
   for (size_type i = 0; i < num_instances; ++i) {
     for (size_type j = 0; j < num_attributes; ++j) {
-      if ((*this)(i, j)) {
-        ++positive_counts_[j];
+      if (data[i * num_attributes + j]) {
+        rows.data[i * words_per_instance_ + j / bits_per_word] |= word_type{1}
+                                                                  << (j % bits_per_word);
+        ++rows.positive_counts[j];
+        rows.positive_attributes.push_back(static_cast<index_type>(j));
+      }
+    }
+    rows.row_offsets.push_back(rows.positive_attributes.size());
+  }
+  adopt(std::move(rows));
+}
+
+inline dataset::dataset(binary_format_t /*tag*/, detail::mapped_file file) {
+  std::string_view const bytes = file.view();
+  detail::binary_header header{};
+  if (!is_binary(bytes) || bytes.size() < sizeof(header)) {
+    throw std::runtime_error{"not a binary dataset file"};
+  }
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  if (header.byte_order != detail::binary_byte_order_mark) {
+    throw std::runtime_error{"binary dataset was written with a different byte order"};
+  }
+  if (header.version != detail::binary_version) {
+    throw std::runtime_error{"unsupported binary dataset version " +
+                             std::to_string(header.version)};
+  }
+  if constexpr (sizeof(size_type) != sizeof(std::uint64_t)) {
+    throw std::runtime_error{"binary datasets require a 64-bit size_type"};
+  }
+  auto const layout = detail::compute_binary_layout(header);
+  if (!layout || layout->total != bytes.size() ||
+      header.num_attributes > std::numeric_limits<index_type>::max() ||
+      header.words_per_instance !=
+          (header.num_attributes + bits_per_word - 1) / bits_per_word) {
+    throw std::runtime_error{"binary dataset file is truncated or inconsistent"};
+  }
+
+  // Attribute names are the only section that is copied.
+  auto const num_attributes = static_cast<size_type>(header.num_attributes);
+  std::vector<std::uint64_t> name_offsets(num_attributes + 1);
+  std::memcpy(name_offsets.data(), bytes.data() + layout->name_offsets,
+              name_offsets.size() * sizeof(std::uint64_t));
+  if (name_offsets.front() != 0 || name_offsets.back() != header.names_bytes ||
+      !std::ranges::is_sorted(name_offsets)) {
+    throw std::runtime_error{"binary dataset file has a corrupt name table"};
+  }
+  names_.reserve(num_attributes);
+  for (size_type j = 0; j < num_attributes; ++j) {
+    names_.emplace_back(bytes.substr(layout->names + name_offsets[j],
+                                     name_offsets[j + 1] - name_offsets[j]));
+  }
+  words_per_instance_ = static_cast<size_type>(header.words_per_instance);
+  num_instances_ = static_cast<size_type>(header.num_instances);
+
+  auto owned = std::make_shared<mapped_storage>(mapped_storage{std::move(file), {}, {}});
+  char const *const base = owned->file.view().data();
+  data_ = {reinterpret_cast<word_type const *>(base + layout->words),
+           num_instances_ * words_per_instance_};
+  positive_counts_ = {reinterpret_cast<size_type const *>(base + layout->positive_counts),
+                      num_attributes};
+  if ((header.flags & detail::binary_flag_index) != 0U) {
+    row_offsets_ = {reinterpret_cast<size_type const *>(base + layout->row_offsets),
+                    num_instances_ + 1};
+    positive_attributes_ = {
+        reinterpret_cast<index_type const *>(base + layout->positive_attributes),
+        static_cast<size_type>(header.num_positive)};
+    if (row_offsets_.front() != 0 || row_offsets_.back() != positive_attributes_.size()) {
+      throw std::runtime_error{"binary dataset file has a corrupt index"};
+    }
+  } else {
+    owned->row_offsets.reserve(num_instances_ + 1);
+    owned->row_offsets.push_back(0);
+    for (size_type i = 0; i < num_instances_; ++i) {
+      for (size_type w = 0; w < words_per_instance_; ++w) {
+        for (word_type word = data_[i * words_per_instance_ + w]; word != 0U; word &= word - 1) {
+          owned->positive_attributes.push_back(static_cast<index_type>(
+              w * bits_per_word + static_cast<size_type>(std::countr_zero(word))));
+        }
       }
+      owned->row_offsets.push_back(owned->positive_attributes.size());
     }
+    row_offsets_ = owned->row_offsets;
+    positive_attributes_ = owned->positive_attributes;
+  }
+  storage_ = std::move(owned);
+}
+
+inline void dataset::write_binary(std::ostream &os, bool include_index) const {
+  detail::binary_header header{};
+  header.magic = detail::binary_magic;
+  header.byte_order = detail::binary_byte_order_mark;
+  header.version = detail::binary_version;
+  header.flags = include_index ? detail::binary_flag_index : 0U;
+  header.num_instances = num_instances_;
+  header.num_attributes = num_attributes();
+  header.words_per_instance = words_per_instance_;
+  header.num_positive = num_instances_ == 0 ? 0 : row_offsets_[num_instances_];
+  std::vector<std::uint64_t> name_offsets{0};
+  for (auto const &name : names_) {
+    name_offsets.push_back(name_offsets.back() + name.size());
+  }
+  header.names_bytes = name_offsets.back();
+  auto const layout = detail::compute_binary_layout(header);
+  if (!layout) {
+    throw std::runtime_error{"dataset is too large for the binary format"};
+  }
+
+  std::size_t written = 0;
+  auto const put = [&](std::size_t offset, void const *data, std::size_t size) {
+    static constexpr char zeros[8]{};
+    os.write(zeros, static_cast<std::streamsize>(offset - written));
+    os.write(static_cast<char const *>(data), static_cast<std::streamsize>(size));
+    written = offset + size;
+  };
+  put(0, &header, sizeof(header));
+  put(layout->name_offsets, name_offsets.data(), name_offsets.size() * sizeof(std::uint64_t));
+  std::size_t names_written = layout->names;
+  for (auto const &name : names_) {
+    put(names_written, name.data(), name.size());
+    names_written += name.size();
+  }
+  put(layout->positive_counts, positive_counts_.data(), positive_counts_.size_bytes());
+  put(layout->words, data_.data(), data_.size_bytes());
+  if (include_index) {
+    std::vector<std::uint64_t> const offsets =
+        num_instances_ == 0 ? std::vector<std::uint64_t>{0}
+                            : std::vector<std::uint64_t>(row_offsets_.begin(), row_offsets_.end());
+    put(layout->row_offsets, offsets.data(), offsets.size() * sizeof(std::uint64_t));
+    put(layout->positive_attributes, positive_attributes_.data(),
+        positive_attributes_.size_bytes());
+  }
+  put(layout->total, nullptr, 0);
+  if (!os) {
+    throw std::runtime_error{"failed to write binary dataset"};
   }
 }
 
@@ -251,17 +846,16 @@ inline std::ostream &operator<<(std::ostream &os, dataset const &ds) {
       os << '\t';
     }
   }
-  // ds.data_ is std::vector<bool>; range-iter yields proxy refs, so
-  // explicitly cast through int to print as 0/1 rather than relying on
-  // the proxy's implicit conversion sequence.
-  for (auto const val : ds.data_) {
-    os << static_cast<int>(val);
-    ++attribute_num;
-    if (attribute_num == ds.num_attributes()) {
-      os << '\n';
-      attribute_num = 0;
-    } else {
-      os << '\t';
+  for (dataset::size_type i = 0; i < ds.num_instances(); ++i) {
+    for (auto it = ds.cbegin(i); it != ds.cend(i); ++it) {
+      os << static_cast<int>(*it);
+      ++attribute_num;
+      if (attribute_num == ds.num_attributes()) {
+        os << '\n';
+        attribute_num = 0;
+      } else {
+        os << '\t';
+      }
     }
   }
   return os;
@@ -0,0 +1,241 @@
+#ifndef POPC_DETAIL_APPROX_POWER_HPP
+#define POPC_DETAIL_APPROX_POWER_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define POPC_APPROX_POWER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace popc::detail {
+
+/**
+ * @brief Bit layout and polynomial degrees of approx_pow() for one type.
+ *
+ * `log_terms` odd powers of `t` approximate `log2` and a polynomial of
+ * degree `exp_degree` approximates `2^f`; both truncation errors stay
+ * below a unit in the last place of the type.
+ */
+template <typename fptype> struct approx_pow_traits;
+
+template <> struct approx_pow_traits<double> {
+  using bits_type = std::uint64_t;
+  static constexpr int mantissa_bits = 52;
+  static constexpr std::size_t log_terms = 9;
+  static constexpr std::size_t exp_degree = 12;
+};
+
+template <> struct approx_pow_traits<float> {
+  using bits_type = std::uint32_t;
+  static constexpr int mantissa_bits = 23;
+  static constexpr std::size_t log_terms = 5;
+  static constexpr std::size_t exp_degree = 7;
+};
+
+/**
+ * @brief Coefficients of approx_pow(): `2 / ((2k + 1) ln 2)` of the
+ * `log2` series in `t = (m - 1) / (m + 1)`, and `(ln 2)^i / i!` of `2^f`.
+ */
+template <typename fptype> struct approx_pow_coefficients {
+  std::array<fptype, approx_pow_traits<fptype>::log_terms> log2;
+  std::array<fptype, approx_pow_traits<fptype>::exp_degree + 1> exp2;
+};
+
+template <typename fptype>
+[[nodiscard]] constexpr approx_pow_coefficients<fptype> make_approx_pow_coefficients() noexcept {
+  approx_pow_coefficients<fptype> out{};
+  for (std::size_t k = 0; k < out.log2.size(); ++k) {
+    out.log2[k] = static_cast<fptype>(2 / (static_cast<double>(2 * k + 1) * std::numbers::ln2));
+  }
+  double term = 1;
+  for (std::size_t i = 0; i < out.exp2.size(); ++i) {
+    out.exp2[i] = static_cast<fptype>(term);
+    term *= std::numbers::ln2 / static_cast<double>(i + 1);
+  }
+  return out;
+}
+
+template <typename fptype>
+inline constexpr approx_pow_coefficients<fptype> approx_pow_coefficients_v =
+    make_approx_pow_coefficients<fptype>();
+
+/**
+ * @brief Approximate `base^power` as `2^(power * log2(base))`.
+ *
+ * Splits `base` into `m * 2^e` with `m` in `[sqrt(1/2), sqrt(2))`, sums
+ * the `atanh` series of `log2(m)`, and evaluates `2^y` as `2^k` times a
+ * Taylor polynomial of `2^f` with `k` the nearest integer to `y` and
+ * `|f| <= 1/2`. Branch-free: every step is a multiply, add or bit
+ * operation, so the vector row kernels repeat it lane by lane and round
+ * exactly as this function does.
+ *
+ * Requires a positive, normal `base` and `base^power <= 1`, as for every
+ * POPC probability with `Cm >= 0` and `P >= 0`. Results are then within
+ * a relative `(2 |y| + 4 power + 8) * epsilon` of the exact power, with
+ * `y = power * log2(base)`, down to the smallest normal number; smaller
+ * ones are clamped to within a factor of `sqrt(2)` of it.
+ */
+template <typename fptype>
+[[nodiscard]] inline fptype approx_pow(fptype base, fptype power) noexcept {
+  using traits = approx_pow_traits<fptype>;
+  using bits_type = typename traits::bits_type;
+  constexpr int mantissa_bits = traits::mantissa_bits;
+  constexpr auto bias = static_cast<bits_type>(std::numeric_limits<fptype>::max_exponent - 1);
+  constexpr bits_type mantissa_mask = (bits_type{1} << mantissa_bits) - 1;
+  // 2^M with the biased exponent OR-ed into its mantissa reads as 2^M + e.
+  constexpr bits_type exponent_carrier = (bias + mantissa_bits) << mantissa_bits;
+  constexpr auto exponent_offset = static_cast<fptype>((bits_type{1} << mantissa_bits) + bias);
+  // Adding 1.5 * 2^M rounds to an integer, which lands in the low bits.
+  constexpr auto shifter = static_cast<fptype>(3 * (bits_type{1} << (mantissa_bits - 1)));
+  constexpr auto lowest = static_cast<fptype>(std::numeric_limits<fptype>::min_exponent - 1);
+  constexpr auto highest = static_cast<fptype>(std::numeric_limits<fptype>::max_exponent - 2);
+  constexpr auto sqrt2 = static_cast<fptype>(std::numbers::sqrt2);
+  constexpr auto half = static_cast<fptype>(0.5);
+  auto const &coefficients = approx_pow_coefficients_v<fptype>;
+
+  auto const bits = std::bit_cast<bits_type>(base);
+  bits_type biased = bits >> mantissa_bits;
+  fptype m = std::bit_cast<fptype>((bits & mantissa_mask) | (bias << mantissa_bits));
+  bool const high = m > sqrt2;
+  m = high ? m * half : m;
+  biased += high ? 1 : 0;
+  fptype const exponent = std::bit_cast<fptype>(biased | exponent_carrier) - exponent_offset;
+
+  fptype const t = (m - 1) / (m + 1);
+  fptype const t2 = t * t;
+  fptype series = coefficients.log2.back();
+  for (std::size_t k = coefficients.log2.size() - 1; k-- > 0;) {
+    series = series * t2 + coefficients.log2[k];
+  }
+  fptype y = power * (exponent + t * series);
+  y = y < lowest ? lowest : y;
+  y = y > highest ? highest : y;
+
+  fptype const rounded = y + shifter;
+  fptype const f = y - (rounded - shifter);
+  fptype poly = coefficients.exp2.back();
+  for (std::size_t i = coefficients.exp2.size() - 1; i-- > 0;) {
+    poly = poly * f + coefficients.exp2[i];
+  }
+  bits_type const k = std::bit_cast<bits_type>(rounded) - std::bit_cast<bits_type>(shifter);
+  return poly * std::bit_cast<fptype>((k + bias) << mantissa_bits);
+}
+
+/**
+ * @brief Portable row kernel: `row[c] = approx_pow((c * multiplier + 1) / denom, power)`.
+ *
+ * The reference every vector kernel must match bit for bit.
+ */
+template <typename fptype>
+inline void approx_power_row_scalar(fptype *row, std::size_t length, fptype multiplier,
+                                    fptype denom, fptype power) {
+  for (std::size_t c = 0; c < length; ++c) {
+    row[c] = approx_pow((static_cast<fptype>(c) * multiplier + 1) / denom, power);
+  }
+}
+
+#ifdef POPC_APPROX_POWER_X86
+
+// The vector kernel below spells out approx_pow() with one intrinsic per
+// scalar operation, in the same order and without fused multiply-adds, so
+// every lane rounds as the scalar kernel does. Counts are converted from
+// 32-bit lanes; approx_power_row() only dispatches here for rows shorter
+// than 2^31 entries.
+
+/** @brief AVX2 row kernel for `double`: four entries per step. */
+__attribute__((target("avx2"))) inline void
+approx_power_row_avx2(double *row, std::size_t length, double multiplier, double denom,
+                      double power) {
+  auto const &coefficients = approx_pow_coefficients_v<double>;
+  __m256i const mantissa_mask = _mm256_set1_epi64x(0x000FFFFFFFFFFFFF);
+  __m256i const one_bits = _mm256_set1_epi64x(0x3FF0000000000000);
+  __m256i const exponent_carrier = _mm256_set1_epi64x(0x4330000000000000);
+  __m256i const unit = _mm256_set1_epi64x(1);
+  __m256i const bias = _mm256_set1_epi64x(1023);
+  __m256d const exponent_offset = _mm256_set1_pd(4503599627371519.0); // 2^52 + 1023
+  __m256d const shifter = _mm256_set1_pd(6755399441055744.0);         // 1.5 * 2^52
+  __m256d const lowest = _mm256_set1_pd(std::numeric_limits<double>::min_exponent - 1);
+  __m256d const highest = _mm256_set1_pd(std::numeric_limits<double>::max_exponent - 2);
+  __m256d const sqrt2 = _mm256_set1_pd(std::numbers::sqrt2);
+  __m256d const half = _mm256_set1_pd(0.5);
+  __m256d const one = _mm256_set1_pd(1.0);
+  __m256d const mult = _mm256_set1_pd(multiplier);
+  __m256d const den = _mm256_set1_pd(denom);
+  __m256d const pw = _mm256_set1_pd(power);
+  std::size_t c = 0;
+  for (; c + 4 <= length; c += 4) {
+    auto const first = static_cast<int>(c);
+    __m256d const count =
+        _mm256_cvtepi32_pd(_mm_setr_epi32(first, first + 1, first + 2, first + 3));
+    __m256d const base = _mm256_div_pd(_mm256_add_pd(_mm256_mul_pd(count, mult), one), den);
+
+    __m256i const bits = _mm256_castpd_si256(base);
+    __m256i biased = _mm256_srli_epi64(bits, 52);
+    __m256d m =
+        _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, mantissa_mask), one_bits));
+    __m256d const high = _mm256_cmp_pd(m, sqrt2, _CMP_GT_OQ);
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(m, half), high);
+    biased = _mm256_add_epi64(biased, _mm256_and_si256(_mm256_castpd_si256(high), unit));
+    __m256d const exponent = _mm256_sub_pd(
+        _mm256_castsi256_pd(_mm256_or_si256(biased, exponent_carrier)), exponent_offset);
+
+    __m256d const t = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+    __m256d const t2 = _mm256_mul_pd(t, t);
+    __m256d series = _mm256_set1_pd(coefficients.log2.back());
+    for (std::size_t k = coefficients.log2.size() - 1; k-- > 0;) {
+      series = _mm256_add_pd(_mm256_mul_pd(series, t2), _mm256_set1_pd(coefficients.log2[k]));
+    }
+    __m256d y = _mm256_mul_pd(pw, _mm256_add_pd(exponent, _mm256_mul_pd(t, series)));
+    y = _mm256_blendv_pd(y, lowest, _mm256_cmp_pd(y, lowest, _CMP_LT_OQ));
+    y = _mm256_blendv_pd(y, highest, _mm256_cmp_pd(y, highest, _CMP_GT_OQ));
+
+    __m256d const rounded = _mm256_add_pd(y, shifter);
+    __m256d const f = _mm256_sub_pd(y, _mm256_sub_pd(rounded, shifter));
+    __m256d poly = _mm256_set1_pd(coefficients.exp2.back());
+    for (std::size_t i = coefficients.exp2.size() - 1; i-- > 0;) {
+      poly = _mm256_add_pd(_mm256_mul_pd(poly, f), _mm256_set1_pd(coefficients.exp2[i]));
+    }
+    __m256i const k =
+        _mm256_sub_epi64(_mm256_castpd_si256(rounded), _mm256_castpd_si256(shifter));
+    __m256d const scale = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(k, bias), 52));
+    _mm256_storeu_pd(row + c, _mm256_mul_pd(poly, scale));
+  }
+  for (std::size_t r = c; r < length; ++r) {
+    row[r] = approx_pow((static_cast<double>(r) * multiplier + 1) / denom, power);
+  }
+}
+
+#endif // POPC_APPROX_POWER_X86
+
+/**
+ * @brief Fill a row with approx_pow() through the widest kernel the CPU supports.
+ *
+ * AVX2 for `double` rows shorter than 2^31 entries when available,
+ * otherwise approx_power_row_scalar(); bit-identical either way. Matches
+ * the power_row_fn signature of popc::detail::power_function.
+ */
+template <typename fptype>
+inline void approx_power_row(fptype *row, std::size_t length, fptype multiplier, fptype denom,
+                             fptype power) {
+#ifdef POPC_APPROX_POWER_X86
+  if constexpr (std::is_same_v<fptype, double>) {
+    static bool const avx2 = __builtin_cpu_supports("avx2");
+    if (avx2 && length <= static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+      approx_power_row_avx2(row, length, multiplier, denom, power);
+      return;
+    }
+  }
+#endif
+  approx_power_row_scalar(row, length, multiplier, denom, power);
+}
+
+} // namespace popc::detail
+
+#endif // POPC_DETAIL_APPROX_POWER_HPP
@@ -0,0 +1,122 @@
+#ifndef POPC_DETAIL_BINARY_FORMAT_HPP
+#define POPC_DETAIL_BINARY_FORMAT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+namespace popc::detail {
+
+/**
+ * @brief Leading bytes of a binary dataset file.
+ *
+ * Chosen so that a binary file can never be mistaken for the text format:
+ * the trailing NUL is not a valid character anywhere in a text header.
+ */
+inline constexpr std::array<char, 8> binary_magic{'P', 'O', 'P', 'C', 'B', 'I', 'N', '\0'};
+
+/**
+ * @brief Written in native byte order; a mismatch on load means the file
+ *        came from a host of the other endianness.
+ */
+inline constexpr std::uint32_t binary_byte_order_mark = 0x01020304U;
+
+/** @brief Current version of the binary dataset layout. */
+inline constexpr std::uint32_t binary_version = 1;
+
+/** @brief Header flag: the CSR set-attribute index sections are present. */
+inline constexpr std::uint64_t binary_flag_index = 1;
+
+/**
+ * @brief Fixed 64-byte header at offset 0 of a binary dataset file.
+ *
+ * The header is followed by these sections, each starting at an 8-byte
+ * aligned offset so that a memory-mapped file can be read in place:
+ *
+ * | Section               | Element           | Count                          |
+ * |-----------------------|-------------------|--------------------------------|
+ * | name offsets          | `uint64_t`        | `num_attributes + 1`           |
+ * | name characters       | `char`            | `names_bytes`                  |
+ * | positive counts       | `uint64_t`        | `num_attributes`               |
+ * | row words             | `uint64_t`        | `num_instances * words_per_instance` |
+ * | row offsets (index)   | `uint64_t`        | `num_instances + 1`            |
+ * | set attributes (index)| `uint32_t`        | `num_positive`                 |
+ *
+ * The two index sections are present only when `flags` has
+ * binary_flag_index. All integers are in the byte order of the writing
+ * host, recorded by `byte_order`.
+ */
+struct binary_header {
+  std::array<char, 8> magic;
+  std::uint32_t byte_order;
+  std::uint32_t version;
+  std::uint64_t flags;
+  std::uint64_t num_instances;
+  std::uint64_t num_attributes;
+  std::uint64_t words_per_instance;
+  std::uint64_t num_positive;
+  std::uint64_t names_bytes;
+};
+static_assert(sizeof(binary_header) == 64, "binary_header must have no padding");
+
+/** @brief Byte offsets of every section of a binary dataset file. */
+struct binary_layout {
+  std::size_t name_offsets;
+  std::size_t names;
+  std::size_t positive_counts;
+  std::size_t words;
+  std::size_t row_offsets;
+  std::size_t positive_attributes;
+  std::size_t total;
+};
+
+/**
+ * @brief Compute the section offsets described by a header.
+ *
+ * @param header Header read from (or about to be written to) a file.
+ * @return The layout, or `std::nullopt` if any section size overflows
+ *         `std::size_t` (only possible for a corrupt header).
+ */
+[[nodiscard]] inline std::optional<binary_layout>
+compute_binary_layout(binary_header const &header) {
+  constexpr std::size_t max = std::numeric_limits<std::size_t>::max();
+  std::size_t offset = sizeof(binary_header);
+  bool ok = true;
+  // Append `count` elements of `size` bytes at the next 8-byte boundary
+  // and return where they start.
+  auto const section = [&](std::uint64_t count, std::size_t size) {
+    offset = (offset + 7) / 8 * 8;
+    std::size_t const start = offset;
+    if (count > (max - offset) / size) {
+      ok = false;
+      return start;
+    }
+    offset += static_cast<std::size_t>(count) * size;
+    return start;
+  };
+  binary_layout layout{};
+  if (header.num_attributes == max || header.num_instances == max ||
+      (header.words_per_instance != 0 &&
+       header.num_instances > max / header.words_per_instance)) {
+    return std::nullopt;
+  }
+  layout.name_offsets = section(header.num_attributes + 1, sizeof(std::uint64_t));
+  layout.names = section(header.names_bytes, 1);
+  layout.positive_counts = section(header.num_attributes, sizeof(std::uint64_t));
+  layout.words =
+      section(header.num_instances * header.words_per_instance, sizeof(std::uint64_t));
+  bool const indexed = (header.flags & binary_flag_index) != 0U;
+  layout.row_offsets = section(indexed ? header.num_instances + 1 : 0, sizeof(std::uint64_t));
+  layout.positive_attributes = section(indexed ? header.num_positive : 0, sizeof(std::uint32_t));
+  layout.total = offset;
+  if (!ok) {
+    return std::nullopt;
+  }
+  return layout;
+}
+
+} // namespace popc::detail
+
+#endif // POPC_DETAIL_BINARY_FORMAT_HPP
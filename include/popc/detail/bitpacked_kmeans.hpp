@@ -5,12 +5,18 @@
 #include <bit>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <numeric>
+#include <optional>
 #include <random>
 #include <span>
+#include <utility>
 #include <vector>
 
 #include "../dataset.hpp"
+#include "hamming.hpp"
+#include "thread_pool.hpp"
+#include "vp_tree.hpp"
 
 namespace popc::detail {
 
@@ -22,49 +28,34 @@ namespace popc::detail {
  * the centroid-recomputation loop in bitpacked_kmodes_seed() to skip
  * out-of-range bookkeeping.
  *
- * Constructed from a `popc::dataset` (whose internal storage is
- * `std::vector<bool>`). The bitpacked form lets distance kernels operate on
- * whole 64-bit words via popcount instead of one bit per branch — the
- * entire point of using it for k-means seeding on binary data.
+ * The view does not own or copy anything: `popc::dataset` already stores
+ * its matrix in this word layout, so the view simply forwards to the
+ * dataset's words. The dataset must outlive the view. Operating on whole
+ * 64-bit words via popcount instead of one bit per branch is the entire
+ * point of using it for k-means seeding on binary data.
  */
 class bitpacked_dataset {
 public:
-  using word_type = std::uint64_t;
-  static constexpr std::size_t bits_per_word = 64;
+  using word_type = popc::dataset::word_type;
+  static constexpr std::size_t bits_per_word = popc::dataset::bits_per_word;
 
   /**
-   * @brief Pack a popc::dataset into 64-bit-word storage.
+   * @brief View a popc::dataset's word storage.
    *
-   * Reads bits from the source dataset row-by-row and lays them out little-end
-   * within each word. Padding bits in the trailing word of each instance
-   * (when `num_attributes()` is not a multiple of 64) are zero-initialized.
-   *
-   * @param ds Source binary dataset to pack.
+   * @param ds Source binary dataset. Must outlive the view.
    */
-  explicit bitpacked_dataset(popc::dataset const &ds)
-      : num_instances_{ds.num_instances()}, num_attributes_{ds.num_attributes()},
-        words_per_instance_{(ds.num_attributes() + bits_per_word - 1) / bits_per_word},
-        data_(num_instances_ * words_per_instance_, word_type{0}) {
-    for (std::size_t i = 0; i < num_instances_; ++i) {
-      std::size_t const base = i * words_per_instance_;
-      std::size_t bit = 0;
-      for (auto it = ds.cbegin(i); it != ds.cend(i); ++it) {
-        if (*it) {
-          data_[base + bit / bits_per_word] |= (word_type{1} << (bit % bits_per_word));
-        }
-        ++bit;
-      }
-    }
-  }
+  explicit bitpacked_dataset(popc::dataset const &ds) noexcept : ds_{&ds} {}
 
   /** @brief Return the number of packed instances. */
-  [[nodiscard]] std::size_t num_instances() const noexcept { return num_instances_; }
+  [[nodiscard]] std::size_t num_instances() const noexcept { return ds_->num_instances(); }
 
   /** @brief Return the number of attributes per instance. */
-  [[nodiscard]] std::size_t num_attributes() const noexcept { return num_attributes_; }
+  [[nodiscard]] std::size_t num_attributes() const noexcept { return ds_->num_attributes(); }
 
   /** @brief Return the number of 64-bit words used to store one instance. */
-  [[nodiscard]] std::size_t words_per_instance() const noexcept { return words_per_instance_; }
+  [[nodiscard]] std::size_t words_per_instance() const noexcept {
+    return ds_->words_per_instance();
+  }
 
   /**
    * @brief Return a read-only span over one packed instance.
@@ -73,36 +64,51 @@ public:
    * @return Span of `words_per_instance()` words.
    */
   [[nodiscard]] std::span<word_type const> instance(std::size_t i) const noexcept {
-    return {data_.data() + i * words_per_instance_, words_per_instance_};
+    return ds_->words(i);
   }
 
 private:
-  std::size_t num_instances_;
-  std::size_t num_attributes_;
-  std::size_t words_per_instance_;
-  std::vector<word_type> data_;
+  popc::dataset const *ds_;
 };
 
 /**
- * @brief Hamming distance between two bitpacked vectors of equal word length.
+ * @brief Cluster count from which bitpacked_kmodes_seed() finds nearest
+ * centroids through a vp_tree instead of scanning them all.
  *
- * Compiles to one popcount instruction per 64 features on x86-64 (POPCNT)
- * and ARMv8 (CNT). The two spans must have the same length; the function
- * does not check.
+ * Below it the scan is cheaper than rebuilding the tree every iteration.
+ */
+inline constexpr std::size_t min_indexed_clusters = 64;
+
+/**
+ * @brief Largest cluster whose bit counts bitpacked_kmodes_seed() recounts
+ * from its members when its centroid changes.
  *
- * @param a First operand.
- * @param b Second operand. Must have the same size as `a`.
- * @return Number of bit positions where `a` and `b` differ.
+ * Larger clusters keep a persistent row of `F` counts updated as instances
+ * move. Fewer than `n / max_recounted_cluster_size` clusters can be that
+ * large, so the rows take at most `4 * n * F / 32` bytes: the size of the
+ * bitpacked dataset.
  */
-[[nodiscard]] inline std::size_t
-hamming_distance(std::span<bitpacked_dataset::word_type const> a,
-                 std::span<bitpacked_dataset::word_type const> b) noexcept {
-  std::size_t dist = 0;
-  for (std::size_t w = 0; w < a.size(); ++w) {
-    dist += static_cast<std::size_t>(std::popcount(a[w] ^ b[w]));
-  }
-  return dist;
-}
+inline constexpr std::size_t max_recounted_cluster_size = 32;
+
+/**
+ * @brief Work done by a bitpacked_kmodes_seed() run.
+ *
+ * Every iteration assigns each instance once. An assignment is settled in
+ * one of three ways, cheapest first; the share of the first two is the
+ * fraction of nearest-centroid searches the bounds skipped.
+ */
+struct kmodes_stats {
+  /** Lloyd's iterations run. */
+  std::size_t iterations = 0;
+  /** Instance assignments: the number of instances times iterations. */
+  std::size_t assignments = 0;
+  /** Assignments kept by the bounds without computing any distance. */
+  std::size_t bound_skipped = 0;
+  /** Assignments kept after recomputing only the distance to the instance's own centroid. */
+  std::size_t tightened_skipped = 0;
+  /** Assignments that searched every centroid, or the centroid tree. */
+  std::size_t searched = 0;
+};
 
 /**
  * @brief Bitpacked binary k-modes clustering for POPC seeding.
@@ -125,10 +131,35 @@ hamming_distance(std::span<bitpacked_dataset::word_type const> a,
  *      b. Reassign each instance to its nearest centroid by Hamming distance.
  *      c. Stop when no instance changes assignment, or after `max_iterations`.
  *
- * With `k = n/2`, each Lloyd's iteration is `O(n^2 * words_per_instance)` —
- * quadratic in n by construction of the algorithm, not by limitation of
- * this implementation. Bitpacking yields a roughly 64x constant-factor
- * speedup over per-bit kernels.
+ * Members are kept in intrusive per-cluster lists. A cluster of more than
+ * max_recounted_cluster_size members also keeps a row of 32-bit bit counts,
+ * updated as instances move; a smaller one is recounted from its members
+ * into `F`-sized scratch when its centroid changes. POPC's `k = n/2` seed
+ * makes most clusters tiny, so the rows stay within the size of the
+ * bitpacked dataset instead of a dense `k x F` table, while step 2a still
+ * costs `O(moves * F/64)` word scans plus `O(F)` per cluster a move
+ * touched. Untouched centroids are not recomputed.
+ *
+ * Step 2b keeps Hamerly's bounds per instance: an upper bound `u` on the
+ * distance to its own centroid and a lower bound `l` on the distance to
+ * every other non-empty centroid. When the centroids move, `u` grows by
+ * the distance its own centroid moved and `l` shrinks by the largest
+ * distance any other centroid moved, by the triangle inequality. While
+ * `u < l` the instance's centroid is strictly nearest and it is kept
+ * without computing a distance; otherwise `u` is first tightened to the
+ * exact distance, and only if that fails is the nearest centroid searched
+ * for, which also yields the second nearest as the new `l`. Once most
+ * centroids settle, most instances skip the search. Elkan's per-centroid
+ * lower bounds would skip more but need `n * k` of them, which is
+ * quadratic with POPC's `k = n/2`.
+ *
+ * A plain assignment step costs `O(n * k * words_per_instance)`, which
+ * with `k = n/2` is quadratic in n. From min_indexed_clusters clusters on,
+ * the non-empty centroids are indexed in a vp_tree each iteration, built
+ * with `O(k log k)` distance computations, and each instance's nearest
+ * centroid is found by an exact tree search that skips most of them when
+ * the data has structure. Bitpacking yields a roughly 64x constant-factor
+ * speedup over per-bit kernels either way.
  *
  * Empty clusters are tolerated and may emerge from Lloyd's iteration;
  * downstream POPC removes them as instances drain.
@@ -140,15 +171,24 @@ hamming_distance(std::span<bitpacked_dataset::word_type const> a,
  * @param seed           Seed for the `std::mt19937_64` used for the random
  *                       initial assignment. Same seed yields the same
  *                       partition for the same input.
+ * @param num_threads    Threads sharing each iteration: the assignment step
+ *                       splits the instances into contiguous ranges, and the
+ *                       centroid step splits the clusters into ranges of
+ *                       about equal membership, each thread counting bits in
+ *                       its own scratch. 1 (the default) runs serially and 0
+ *                       is treated as 1. The result does not depend on this
+ *                       value.
+ * @param stats          When non-null, receives the work done; see
+ *                       kmodes_stats.
  *
  * @return Vector of length `data.num_instances()` mapping each instance
  *         to its final cluster index in `[0, k)`. Empty when `data` has
  *         no instances or `k == 0`.
  */
-[[nodiscard]] inline std::vector<std::size_t> bitpacked_kmodes_seed(bitpacked_dataset const &data,
-                                                                    std::size_t k,
-                                                                    std::size_t max_iterations,
-                                                                    std::uint64_t seed) {
+[[nodiscard]] inline std::vector<std::size_t>
+bitpacked_kmodes_seed(bitpacked_dataset const &data, std::size_t k, std::size_t max_iterations,
+                      std::uint64_t seed, std::size_t num_threads = 1,
+                      kmodes_stats *stats = nullptr) {
   std::size_t const n = data.num_instances();
   std::size_t const f = data.num_attributes();
   std::size_t const wpi = data.words_per_instance();
@@ -172,100 +212,322 @@ hamming_distance(std::span<bitpacked_dataset::word_type const> a,
     }
   }
 
-  // Reusable scratch buffers.
+  // Each loop below runs on `num_tasks` contiguous ranges, one per thread.
+  // Every instance and every cluster is computed exactly as in a serial
+  // run, so the result does not depend on the thread count.
+  std::optional<thread_pool> pool;
+  if (num_threads > 1 && n > 1) {
+    pool.emplace(num_threads);
+  }
+  std::size_t const num_tasks = pool ? pool->size() : 1;
+  auto const run_tasks = [&](auto const &body) {
+    if (pool) {
+      pool->for_each(num_tasks, body);
+    } else {
+      body(std::size_t{0});
+    }
+  };
+
+  // Each cluster's members, as intrusive lists; the bit-count rows of the
+  // clusters above max_recounted_cluster_size, kept current as instances
+  // move, and empty for the others; the clusters whose counts changed since
+  // their centroid was computed; and each task's moves, as (instance, old
+  // cluster) pairs.
+  constexpr std::size_t no_instance = std::numeric_limits<std::size_t>::max();
   std::vector<word_type> centroids(k * wpi, word_type{0});
-  std::vector<std::size_t> bit_counts(f);
+  std::vector<std::size_t> head(k, no_instance);
+  std::vector<std::size_t> next(n, no_instance);
+  std::vector<std::size_t> prev(n, no_instance);
+  std::vector<std::vector<std::uint32_t>> counts(k);
+  std::vector<char> recounted(k);
   std::vector<std::size_t> cluster_sizes(k);
-  std::vector<std::vector<std::size_t>> members(k);
+  std::vector<char> dirty(k, 1);
+  std::vector<std::vector<std::pair<std::size_t, std::size_t>>> task_moves(num_tasks);
+  std::vector<std::vector<word_type>> task_centroid(num_tasks, std::vector<word_type>(wpi));
+  std::vector<std::vector<std::uint32_t>> task_counts(num_tasks, std::vector<std::uint32_t>(f));
+  std::vector<std::vector<std::size_t>> task_distances(
+      num_tasks, std::vector<std::size_t>(k < min_indexed_clusters ? k : 0));
+  std::vector<std::size_t> first_cluster(num_tasks + 1);
+  std::vector<char> task_changed(num_tasks);
+  std::vector<std::size_t> live;
+  vp_tree tree;
 
-  for (std::size_t iter = 0; iter < max_iterations; ++iter) {
-    // Bucket instances by cluster.
-    for (auto &m : members) {
-      m.clear();
+  // Hamerly's bounds (see above) and the distance each centroid moved in
+  // the last centroid step. The bounds are only valid after the first
+  // assignment step.
+  std::vector<std::size_t> drift(k);
+  std::vector<std::size_t> upper(n);
+  std::vector<std::size_t> lower(n);
+  std::vector<kmodes_stats> task_stats(num_tasks);
+  std::size_t iterations = 0;
+
+  auto const add_member = [&](std::size_t i, std::size_t c) {
+    next[i] = head[c];
+    prev[i] = no_instance;
+    if (head[c] != no_instance) {
+      prev[head[c]] = i;
     }
-    for (std::size_t i = 0; i < n; ++i) {
-      members[assignments[i]].push_back(i);
+    head[c] = i;
+  };
+  auto const remove_member = [&](std::size_t i, std::size_t c) {
+    (prev[i] == no_instance ? head[c] : next[prev[i]]) = next[i];
+    if (next[i] != no_instance) {
+      prev[next[i]] = prev[i];
     }
+  };
+  for (std::size_t i = 0; i < n; ++i) {
+    ++cluster_sizes[assignments[i]];
+    add_member(i, assignments[i]);
+  }
 
-    // Step 2a: recompute centroids by majority vote.
-    for (std::size_t c = 0; c < k; ++c) {
-      std::size_t const size = members[c].size();
-      cluster_sizes[c] = size;
-      std::size_t const cent_off = c * wpi;
-      std::fill_n(centroids.begin() + static_cast<std::ptrdiff_t>(cent_off), wpi, word_type{0});
-      if (size == 0) {
-        continue;
+  // Add instance `i`'s set bits to the counts in `row`, or remove them.
+  auto const count_bits = [&](std::size_t i, std::uint32_t *row, bool add) {
+    auto const inst = data.instance(i);
+    for (std::size_t w = 0; w < wpi; ++w) {
+      word_type word = inst[w];
+      std::size_t const base = w * bitpacked_dataset::bits_per_word;
+      // Padding bits in the trailing word are guaranteed zero by
+      // popc::dataset's storage layout, so no set bit can have
+      // base + b >= f.
+      while (word != 0U) {
+        auto const b = static_cast<std::size_t>(std::countr_zero(word));
+        if (add) {
+          ++row[base + b];
+        } else {
+          --row[base + b];
+        }
+        word &= word - 1;
       }
-      std::ranges::fill(bit_counts, std::size_t{0});
-      for (std::size_t i : members[c]) {
-        auto const inst = data.instance(i);
-        for (std::size_t w = 0; w < wpi; ++w) {
-          word_type word = inst[w];
-          std::size_t const base = w * bitpacked_dataset::bits_per_word;
-          // Padding bits in the trailing word are guaranteed zero by
-          // bitpacked_dataset's constructor, so no set bit can have
-          // base + b >= f.
-          while (word != 0U) {
-            auto const b = static_cast<std::size_t>(std::countr_zero(word));
-            ++bit_counts[base + b];
-            word &= word - 1;
+    }
+  };
+
+  for (std::size_t iter = 0; iter < max_iterations; ++iter) {
+    ++iterations;
+    // Settle the sizes of the clusters the last assignment step changed.
+    for (auto const &moves : task_moves) {
+      for (auto const &[i, from] : moves) {
+        --cluster_sizes[from];
+        ++cluster_sizes[assignments[i]];
+        dirty[from] = 1;
+        dirty[assignments[i]] = 1;
+        remove_member(i, from);
+        add_member(i, assignments[i]);
+      }
+    }
+
+    // Split the clusters into ranges of about n / num_tasks members each,
+    // so a few large clusters do not leave the other threads idle. Each
+    // task updates the counts of its own clusters only.
+    {
+      std::size_t c = 0;
+      std::size_t seen = 0;
+      for (std::size_t t = 0; t < num_tasks; ++t) {
+        first_cluster[t] = c;
+        std::size_t const target = n / num_tasks * (t + 1);
+        while (c < k && seen < target) {
+          seen += cluster_sizes[c++];
+        }
+      }
+      first_cluster[num_tasks] = k;
+    }
+
+    // Count a cluster's members once when it outgrows
+    // max_recounted_cluster_size, then only the moves: late iterations move
+    // few instances, and their cost shrinks with them. Rows of clusters that
+    // shrank back are released.
+    run_tasks([&](std::size_t task) {
+      for (std::size_t c = first_cluster[task]; c < first_cluster[task + 1]; ++c) {
+        recounted[c] = 0;
+        if (cluster_sizes[c] <= max_recounted_cluster_size) {
+          counts[c] = {};
+        } else if (counts[c].empty()) {
+          counts[c].assign(f, 0);
+          for (std::size_t i = head[c]; i != no_instance; i = next[i]) {
+            count_bits(i, counts[c].data(), true);
           }
+          recounted[c] = 1;
         }
       }
-      // Strict majority: count > size - count is equivalent to 2*count > size
-      // but avoids the intermediate multiplication that would overflow on a
-      // 32-bit size_t with cluster sizes above ~2 billion.
-      for (std::size_t j = 0; j < f; ++j) {
-        if (bit_counts[j] > size - bit_counts[j]) {
-          centroids[cent_off + j / bitpacked_dataset::bits_per_word] |=
-              (word_type{1} << (j % bitpacked_dataset::bits_per_word));
+      // A row counted above already includes this iteration's moves.
+      auto const tracked = [&](std::size_t c) {
+        return c >= first_cluster[task] && c < first_cluster[task + 1] && !counts[c].empty() &&
+               recounted[c] == 0;
+      };
+      for (auto const &moves : task_moves) {
+        for (auto const &[i, from] : moves) {
+          if (tracked(from)) {
+            count_bits(i, counts[from].data(), false);
+          }
+          if (tracked(assignments[i])) {
+            count_bits(i, counts[assignments[i]].data(), true);
+          }
         }
       }
-    }
+    });
 
-    // Step 2b: reassign instances to nearest centroid.
-    bool changed = false;
-    for (std::size_t i = 0; i < n; ++i) {
-      auto const inst = data.instance(i);
-      std::size_t best_c = assignments[i];
-      std::size_t best_d = std::numeric_limits<std::size_t>::max();
-      for (std::size_t c = 0; c < k; ++c) {
-        // Skip centroids of empty clusters: they are all-zero, which
-        // would attract every all-zero-ish instance and starve other
-        // clusters. Leaving an instance assigned to its current cluster
-        // when no non-empty cluster is closer keeps the partition
-        // moving rather than collapsing.
-        if (cluster_sizes[c] == 0) {
+    // Step 2a: recompute the centroids of changed clusters by majority vote,
+    // measuring how far each moved; the others stay put.
+    run_tasks([&](std::size_t task) {
+      auto &centroid = task_centroid[task];
+      auto &scratch = task_counts[task];
+      for (std::size_t c = first_cluster[task]; c < first_cluster[task + 1]; ++c) {
+        drift[c] = 0;
+        if (dirty[c] == 0) {
           continue;
         }
-        std::span<word_type const> cent{centroids.data() + c * wpi, wpi};
-        std::size_t const d = hamming_distance(inst, cent);
-        if (d < best_d) {
-          best_d = d;
-          best_c = c;
+        dirty[c] = 0;
+        std::size_t const size = cluster_sizes[c];
+        std::uint32_t const *row = counts[c].data();
+        if (counts[c].empty()) {
+          std::ranges::fill(scratch, std::uint32_t{0});
+          for (std::size_t i = head[c]; i != no_instance; i = next[i]) {
+            count_bits(i, scratch.data(), true);
+          }
+          row = scratch.data();
+        }
+        std::ranges::fill(centroid, word_type{0});
+        // Strict majority: count > size - count is equivalent to 2*count > size
+        // but avoids the intermediate multiplication that would overflow on a
+        // 32-bit size_t with cluster sizes above ~2 billion. An empty
+        // cluster's centroid is all zero.
+        for (std::size_t j = 0; j < f; ++j) {
+          std::size_t const count = row[j];
+          if (count > size - count) {
+            centroid[j / bitpacked_dataset::bits_per_word] |=
+                (word_type{1} << (j % bitpacked_dataset::bits_per_word));
+          }
         }
+        std::span<word_type> const current{centroids.data() + c * wpi, wpi};
+        drift[c] = hamming_distance(current, centroid);
+        std::ranges::copy(centroid, current.begin());
       }
-      if (assignments[i] != best_c) {
-        assignments[i] = best_c;
-        changed = true;
+    });
+
+    // The two largest drifts: every instance's lower bound shrinks by the
+    // largest drift of a centroid other than its own.
+    std::size_t max_drift = 0;
+    std::size_t max_drift_cluster = k;
+    std::size_t second_drift = 0;
+    for (std::size_t c = 0; c < k; ++c) {
+      if (cluster_sizes[c] == 0) {
+        continue;
       }
+      if (drift[c] > max_drift) {
+        second_drift = max_drift;
+        max_drift = drift[c];
+        max_drift_cluster = c;
+      } else if (drift[c] > second_drift) {
+        second_drift = drift[c];
+      }
+    }
+
+    // Step 2b: reassign instances to nearest centroid, unless the bounds
+    // settle them. With many clusters, index the non-empty centroids in a
+    // vantage-point tree and query it; it returns the same two nearest
+    // centroids as the scan below, ties included.
+    bool const indexed = k >= min_indexed_clusters;
+    if (indexed) {
+      live.clear();
+      for (std::size_t c = 0; c < k; ++c) {
+        if (cluster_sizes[c] != 0) {
+          live.push_back(c);
+        }
+      }
+      tree.build(centroids, wpi, live);
     }
+    run_tasks([&](std::size_t task) {
+      bool changed = false;
+      auto &counted = task_stats[task];
+      auto &moves = task_moves[task];
+      moves.clear();
+      for (std::size_t i = n * task / num_tasks; i < n * (task + 1) / num_tasks; ++i) {
+        auto const inst = data.instance(i);
+        std::size_t const own = assignments[i];
+        ++counted.assignments;
+        if (iter != 0) {
+          // Clusters never regain members once empty, so the candidates
+          // only shrink and the old lower bound still holds for them.
+          upper[i] += drift[own];
+          std::size_t const shrink = own == max_drift_cluster ? second_drift : max_drift;
+          lower[i] = lower[i] > shrink ? lower[i] - shrink : 0;
+          // Strictly: on a tie the lowest cluster index would win, and it
+          // may not be this one.
+          if (upper[i] < lower[i]) {
+            ++counted.bound_skipped;
+            continue;
+          }
+          upper[i] = hamming_distance(inst, {centroids.data() + own * wpi, wpi});
+          if (upper[i] < lower[i]) {
+            ++counted.tightened_skipped;
+            continue;
+          }
+        }
+        ++counted.searched;
+        std::size_t best_c = own;
+        std::size_t best_d = std::numeric_limits<std::size_t>::max();
+        std::size_t second_d = std::numeric_limits<std::size_t>::max();
+        if (indexed) {
+          auto const [first, second] = tree.nearest_two(inst);
+          best_c = first.id;
+          best_d = first.distance;
+          second_d = second.distance;
+        } else {
+          // One kernel call measures every centroid.
+          auto &distances = task_distances[task];
+          hamming_distances(inst, centroids, distances);
+          for (std::size_t c = 0; c < k; ++c) {
+            // Skip centroids of empty clusters: they are all-zero, which
+            // would attract every all-zero-ish instance and starve other
+            // clusters. Leaving an instance assigned to its current cluster
+            // when no non-empty cluster is closer keeps the partition
+            // moving rather than collapsing.
+            if (cluster_sizes[c] == 0) {
+              continue;
+            }
+            std::size_t const d = distances[c];
+            if (d < best_d) {
+              second_d = best_d;
+              best_d = d;
+              best_c = c;
+            } else if (d < second_d) {
+              second_d = d;
+            }
+          }
+        }
+        upper[i] = best_d;
+        lower[i] = second_d;
+        if (own != best_c) {
+          assignments[i] = best_c;
+          moves.emplace_back(i, own);
+          changed = true;
+        }
+      }
+      task_changed[task] = changed ? 1 : 0;
+    });
 
-    if (!changed) {
+    if (std::ranges::find(task_changed, char{1}) == task_changed.end()) {
       break;
     }
   }
 
+  if (stats != nullptr) {
+    *stats = {.iterations = iterations};
+    for (auto const &counted : task_stats) {
+      stats->assignments += counted.assignments;
+      stats->bound_skipped += counted.bound_skipped;
+      stats->tightened_skipped += counted.tightened_skipped;
+      stats->searched += counted.searched;
+    }
+  }
   return assignments;
 }
 
 /**
- * @brief Convenience overload: pack a popc::dataset and seed in one call.
+ * @brief Convenience overload: seed directly from a popc::dataset.
  *
- * Equivalent to constructing a `bitpacked_dataset` from `ds` and calling
- * the primary `bitpacked_kmodes_seed` overload. Use the primary overload
- * when you intend to call the seeder more than once on the same data, so
- * the bitpacking work is paid only once.
+ * Equivalent to constructing a `bitpacked_dataset` view over `ds` and
+ * calling the primary `bitpacked_kmodes_seed` overload. The view reads
+ * the dataset's own word storage, so no packed copy is made.
  *
  * @param ds             Source binary dataset.
  * @param k              Requested number of clusters.
@@ -273,14 +535,18 @@ hamming_distance(std::span<bitpacked_dataset::word_type const> a,
  * @param seed           PRNG seed. Defaults to a value drawn from
  *                       `std::random_device`, so calls are non-reproducible
  *                       unless an explicit seed is supplied.
+ * @param num_threads    Threads sharing each iteration; see the primary
+ *                       overload.
+ * @param stats          When non-null, receives the work done.
  *
  * @return Cluster-assignment vector; see the primary overload.
  */
 [[nodiscard]] inline std::vector<std::size_t>
 bitpacked_kmodes_seed(popc::dataset const &ds, std::size_t k, std::size_t max_iterations = 32,
-                      std::uint64_t seed = std::random_device{}()) {
+                      std::uint64_t seed = std::random_device{}(), std::size_t num_threads = 1,
+                      kmodes_stats *stats = nullptr) {
   bitpacked_dataset const data{ds};
-  return bitpacked_kmodes_seed(data, k, max_iterations, seed);
+  return bitpacked_kmodes_seed(data, k, max_iterations, seed, num_threads, stats);
 }
 
 } // namespace popc::detail
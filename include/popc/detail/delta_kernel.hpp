@@ -0,0 +1,181 @@
+#ifndef POPC_DETAIL_DELTA_KERNEL_HPP
+#define POPC_DETAIL_DELTA_KERNEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define POPC_DELTA_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace popc::detail {
+
+/**
+ * @brief Signature of a candidate-delta accumulation kernel.
+ *
+ * For every `k` in `[0, n)` performs `acc[k] -= row[counts[k]]` and then
+ * `acc[k] += row[counts[k] + 1]`: the destination terms of one attribute
+ * for `n` candidate clusters whose counts of that attribute are
+ * `counts[0..n)`. `row` is the attribute's power_table row.
+ */
+template <typename fptype>
+using accumulate_terms_fn = void (*)(fptype *acc, std::uint32_t const *counts, std::size_t n,
+                                     fptype const *row);
+
+/** @brief Portable scalar kernel; the reference every vector kernel must match bit for bit. */
+template <typename fptype>
+inline void accumulate_terms_scalar(fptype *acc, std::uint32_t const *counts, std::size_t n,
+                                    fptype const *row) {
+  for (std::size_t k = 0; k < n; ++k) {
+    acc[k] -= row[counts[k]];
+    acc[k] += row[counts[k] + 1];
+  }
+}
+
+#ifdef POPC_DELTA_KERNEL_X86
+
+// The vector kernels gather both terms of several candidates at once and
+// apply them with a separate subtract and add per lane, so every lane
+// rounds exactly as the scalar kernel does. Gathers take signed 32-bit
+// indices; accumulate_terms() only dispatches here for rows shorter than
+// 2^31 entries. The masked gather forms with a zeroed source are used
+// because GCC warns about the undefined source of the unmasked ones.
+
+/** @brief AVX2 kernel for `double`: four candidates per step. */
+__attribute__((target("avx2"))) inline void
+accumulate_terms_avx2(double *acc, std::uint32_t const *counts, std::size_t n, double const *row) {
+  __m256d const zero = _mm256_setzero_pd();
+  __m256d const all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+  std::size_t k = 0;
+  for (; k + 4 <= n; k += 4) {
+    __m128i const idx = _mm_loadu_si128(reinterpret_cast<__m128i const *>(counts + k));
+    __m256d const old_terms = _mm256_mask_i32gather_pd(zero, row, idx, all, 8);
+    __m256d const new_terms = _mm256_mask_i32gather_pd(zero, row + 1, idx, all, 8);
+    __m256d a = _mm256_loadu_pd(acc + k);
+    a = _mm256_sub_pd(a, old_terms);
+    a = _mm256_add_pd(a, new_terms);
+    _mm256_storeu_pd(acc + k, a);
+  }
+  accumulate_terms_scalar(acc + k, counts + k, n - k, row);
+}
+
+/** @brief AVX2 kernel for `float`: eight candidates per step. */
+__attribute__((target("avx2"))) inline void
+accumulate_terms_avx2(float *acc, std::uint32_t const *counts, std::size_t n, float const *row) {
+  __m256 const zero = _mm256_setzero_ps();
+  __m256 const all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+  std::size_t k = 0;
+  for (; k + 8 <= n; k += 8) {
+    __m256i const idx = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(counts + k));
+    __m256 const old_terms = _mm256_mask_i32gather_ps(zero, row, idx, all, 4);
+    __m256 const new_terms = _mm256_mask_i32gather_ps(zero, row + 1, idx, all, 4);
+    __m256 a = _mm256_loadu_ps(acc + k);
+    a = _mm256_sub_ps(a, old_terms);
+    a = _mm256_add_ps(a, new_terms);
+    _mm256_storeu_ps(acc + k, a);
+  }
+  accumulate_terms_scalar(acc + k, counts + k, n - k, row);
+}
+
+// Without optimization, GCC expands the AVX-512 gathers as macros that pass
+// the mask to a builtin taking a signed type, which -Wsign-conversion flags
+// inside the system header's expansion.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#endif
+
+/** @brief AVX-512F kernel for `double`: eight candidates per step. */
+__attribute__((target("avx512f"))) inline void
+accumulate_terms_avx512(double *acc, std::uint32_t const *counts, std::size_t n,
+                        double const *row) {
+  __m512d const zero = _mm512_setzero_pd();
+  std::size_t k = 0;
+  for (; k + 8 <= n; k += 8) {
+    __m256i const idx = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(counts + k));
+    __m512d const old_terms = _mm512_mask_i32gather_pd(zero, 0xFF, idx, row, 8);
+    __m512d const new_terms = _mm512_mask_i32gather_pd(zero, 0xFF, idx, row + 1, 8);
+    __m512d a = _mm512_loadu_pd(acc + k);
+    a = _mm512_sub_pd(a, old_terms);
+    a = _mm512_add_pd(a, new_terms);
+    _mm512_storeu_pd(acc + k, a);
+  }
+  accumulate_terms_scalar(acc + k, counts + k, n - k, row);
+}
+
+/** @brief AVX-512F kernel for `float`: sixteen candidates per step. */
+__attribute__((target("avx512f"))) inline void
+accumulate_terms_avx512(float *acc, std::uint32_t const *counts, std::size_t n, float const *row) {
+  __m512 const zero = _mm512_setzero_ps();
+  std::size_t k = 0;
+  for (; k + 16 <= n; k += 16) {
+    __m512i const idx = _mm512_loadu_si512(counts + k);
+    __m512 const old_terms = _mm512_mask_i32gather_ps(zero, 0xFFFF, idx, row, 4);
+    __m512 const new_terms = _mm512_mask_i32gather_ps(zero, 0xFFFF, idx, row + 1, 4);
+    __m512 a = _mm512_loadu_ps(acc + k);
+    a = _mm512_sub_ps(a, old_terms);
+    a = _mm512_add_ps(a, new_terms);
+    _mm512_storeu_ps(acc + k, a);
+  }
+  accumulate_terms_scalar(acc + k, counts + k, n - k, row);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // POPC_DELTA_KERNEL_X86
+
+/**
+ * @brief Pick the widest accumulation kernel the running CPU supports.
+ *
+ * Resolved once per process and type: AVX-512F when available, otherwise
+ * AVX2, otherwise the portable scalar kernel. Types other than `float`
+ * and `double` always get the scalar kernel.
+ */
+template <typename fptype> [[nodiscard]] accumulate_terms_fn<fptype> select_accumulate_terms() {
+#ifdef POPC_DELTA_KERNEL_X86
+  if constexpr (std::is_same_v<fptype, double> || std::is_same_v<fptype, float>) {
+    static accumulate_terms_fn<fptype> const selected = [] {
+      if (__builtin_cpu_supports("avx512f")) {
+        return static_cast<accumulate_terms_fn<fptype>>(accumulate_terms_avx512);
+      }
+      if (__builtin_cpu_supports("avx2")) {
+        return static_cast<accumulate_terms_fn<fptype>>(accumulate_terms_avx2);
+      }
+      return accumulate_terms_fn<fptype>{accumulate_terms_scalar<fptype>};
+    }();
+    return selected;
+  }
+#endif
+  return accumulate_terms_scalar<fptype>;
+}
+
+/**
+ * @brief Add one attribute's destination terms to a row of candidates.
+ *
+ * Runs the selected kernel over `acc.size()` candidates. Bit-identical to
+ * accumulate_terms_scalar() whichever kernel runs.
+ *
+ * @param acc    Per-candidate delta accumulators.
+ * @param counts The attribute's count in each candidate; same length as
+ *               `acc`, and every `counts[k] + 1` must index `row`.
+ * @param row    The attribute's power_table row.
+ */
+template <typename fptype>
+inline void accumulate_terms(std::span<fptype> acc, std::span<std::uint32_t const> counts,
+                             std::span<fptype const> row) {
+  if (row.size() > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+    accumulate_terms_scalar(acc.data(), counts.data(), acc.size(), row.data());
+    return;
+  }
+  select_accumulate_terms<fptype>()(acc.data(), counts.data(), acc.size(), row.data());
+}
+
+} // namespace popc::detail
+
+#endif // POPC_DETAIL_DELTA_KERNEL_HPP
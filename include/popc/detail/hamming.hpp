@@ -0,0 +1,306 @@
+#ifndef POPC_DETAIL_HAMMING_HPP
+#define POPC_DETAIL_HAMMING_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "../dataset.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define POPC_HAMMING_X86 1
+#include <immintrin.h>
+#endif
+
+namespace popc::detail {
+
+/**
+ * @brief Signature of a Hamming distance kernel.
+ *
+ * Returns the number of differing bits between the `words`-word vectors
+ * at `a` and `b`.
+ */
+using hamming_distance_fn = std::size_t (*)(popc::dataset::word_type const *a,
+                                            popc::dataset::word_type const *b, std::size_t words);
+
+/**
+ * @brief Signature of a one-vs-many Hamming distance kernel.
+ *
+ * Sets `out[c]` to the distance between the `words`-word `query` and
+ * the `c`-th of `count` vectors stored back to back at `points`.
+ */
+using hamming_distances_fn = void (*)(popc::dataset::word_type const *query,
+                                      popc::dataset::word_type const *points, std::size_t words,
+                                      std::size_t count, std::size_t *out);
+
+/** @brief Portable scalar kernel; the reference every vector kernel must match. */
+inline std::size_t hamming_distance_scalar(popc::dataset::word_type const *a,
+                                           popc::dataset::word_type const *b,
+                                           std::size_t words) noexcept {
+  std::size_t dist = 0;
+  for (std::size_t w = 0; w < words; ++w) {
+    dist += static_cast<std::size_t>(std::popcount(a[w] ^ b[w]));
+  }
+  return dist;
+}
+
+/** @brief Portable scalar one-vs-many kernel. */
+inline void hamming_distances_scalar(popc::dataset::word_type const *query,
+                                     popc::dataset::word_type const *points, std::size_t words,
+                                     std::size_t count, std::size_t *out) noexcept {
+  for (std::size_t c = 0; c < count; ++c) {
+    out[c] = hamming_distance_scalar(query, points + c * words, words);
+  }
+}
+
+#ifdef POPC_HAMMING_X86
+
+// Without -mpopcnt, std::popcount in the scalar kernel is a sequence of
+// shifts and masks per word. The AVX2 kernel counts whole 256-bit vectors
+// with a nibble lookup table (PSHUFB) and, for rows of 16 vectors or more,
+// first folds them with a Harley-Seal carry-save adder tree so only one
+// vector in sixteen is counted; short rows and leftover words use the
+// POPCNT instruction, which every AVX2 processor has.
+// The AVX-512 kernel counts eight words per VPOPCNTQ and loads the tail
+// under a mask. The one-vs-many kernels call the row loop for each point,
+// so the dispatch is paid once per block rather than once per distance.
+
+/** @brief Per-byte popcounts of `v` by nibble table lookup. */
+__attribute__((target("avx2"))) inline __m256i popcount_bytes_avx2(__m256i v) noexcept {
+  __m256i const table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1,
+                                         2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  __m256i const low_nibbles = _mm256_set1_epi8(0x0F);
+  __m256i const lo = _mm256_and_si256(v, low_nibbles);
+  __m256i const hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibbles);
+  return _mm256_add_epi8(_mm256_shuffle_epi8(table, lo), _mm256_shuffle_epi8(table, hi));
+}
+
+/** @brief Popcounts of the four 64-bit lanes of `v`. */
+__attribute__((target("avx2"))) inline __m256i popcount_lanes_avx2(__m256i v) noexcept {
+  return _mm256_sad_epu8(popcount_bytes_avx2(v), _mm256_setzero_si256());
+}
+
+/** @brief Carry-save adder: `sum` and `carry` of the bitwise sum `a + b + c`. */
+__attribute__((target("avx2"))) inline void csa_avx2(__m256i &carry, __m256i &sum, __m256i a,
+                                                     __m256i b, __m256i c) noexcept {
+  __m256i const u = _mm256_xor_si256(a, b);
+  carry = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+  sum = _mm256_xor_si256(u, c);
+}
+
+/** @brief Sum of POPCNT over `words` words of `a ^ b`; faster than vectors for short rows. */
+__attribute__((target("popcnt"))) inline std::size_t
+hamming_distance_popcnt(popc::dataset::word_type const *a, popc::dataset::word_type const *b,
+                        std::size_t words) noexcept {
+  std::size_t dist = 0;
+  for (std::size_t w = 0; w < words; ++w) {
+    dist += static_cast<std::size_t>(_mm_popcnt_u64(a[w] ^ b[w]));
+  }
+  return dist;
+}
+
+/**
+ * @brief Rows shorter than this many words are counted with POPCNT alone.
+ *
+ * Below it, reducing a vector accumulator to a scalar costs more than the
+ * vector instructions save.
+ */
+inline constexpr std::size_t min_vector_hamming_words = 8;
+
+/** @brief `a ^ b` for the vector at word offset `w`. */
+__attribute__((target("avx2"))) inline __m256i xor_at_avx2(popc::dataset::word_type const *a,
+                                                           popc::dataset::word_type const *b,
+                                                           std::size_t w) noexcept {
+  return _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + w)),
+                          _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + w)));
+}
+
+/** @brief AVX2 kernel: Harley-Seal over blocks of sixteen vectors, then a table per vector. */
+__attribute__((target("avx2,popcnt"))) inline std::size_t
+hamming_distance_avx2(popc::dataset::word_type const *a, popc::dataset::word_type const *b,
+                      std::size_t words) noexcept {
+  if (words < min_vector_hamming_words) {
+    return hamming_distance_popcnt(a, b, words);
+  }
+  constexpr std::size_t lanes = 4;
+  __m256i total = _mm256_setzero_si256();
+  std::size_t w = 0;
+  if (words >= 16 * lanes) {
+    // ones..eights hold the running count's low bits, one bit plane each;
+    // every block of sixteen vectors carries out one `sixteens` vector.
+    __m256i ones = _mm256_setzero_si256();
+    __m256i twos = _mm256_setzero_si256();
+    __m256i fours = _mm256_setzero_si256();
+    __m256i eights = _mm256_setzero_si256();
+    __m256i twos_a;
+    __m256i twos_b;
+    __m256i fours_a;
+    __m256i fours_b;
+    __m256i eights_a;
+    __m256i eights_b;
+    __m256i sixteens;
+    __m256i v[16];
+    for (; w + 16 * lanes <= words; w += 16 * lanes) {
+      for (std::size_t i = 0; i < 16; ++i) {
+        v[i] = xor_at_avx2(a, b, w + i * lanes);
+      }
+      csa_avx2(twos_a, ones, ones, v[0], v[1]);
+      csa_avx2(twos_b, ones, ones, v[2], v[3]);
+      csa_avx2(fours_a, twos, twos, twos_a, twos_b);
+      csa_avx2(twos_a, ones, ones, v[4], v[5]);
+      csa_avx2(twos_b, ones, ones, v[6], v[7]);
+      csa_avx2(fours_b, twos, twos, twos_a, twos_b);
+      csa_avx2(eights_a, fours, fours, fours_a, fours_b);
+      csa_avx2(twos_a, ones, ones, v[8], v[9]);
+      csa_avx2(twos_b, ones, ones, v[10], v[11]);
+      csa_avx2(fours_a, twos, twos, twos_a, twos_b);
+      csa_avx2(twos_a, ones, ones, v[12], v[13]);
+      csa_avx2(twos_b, ones, ones, v[14], v[15]);
+      csa_avx2(fours_b, twos, twos, twos_a, twos_b);
+      csa_avx2(eights_b, fours, fours, fours_a, fours_b);
+      csa_avx2(sixteens, eights, eights, eights_a, eights_b);
+      total = _mm256_add_epi64(total, popcount_lanes_avx2(sixteens));
+    }
+    total = _mm256_slli_epi64(total, 4);
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_lanes_avx2(eights), 3));
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_lanes_avx2(fours), 2));
+    total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount_lanes_avx2(twos), 1));
+    total = _mm256_add_epi64(total, popcount_lanes_avx2(ones));
+  }
+  for (; w + lanes <= words; w += lanes) {
+    total = _mm256_add_epi64(total, popcount_lanes_avx2(xor_at_avx2(a, b, w)));
+  }
+  __m128i const half =
+      _mm_add_epi64(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+  auto dist = static_cast<std::size_t>(_mm_cvtsi128_si64(half)) +
+              static_cast<std::size_t>(_mm_extract_epi64(half, 1));
+  return dist + hamming_distance_popcnt(a + w, b + w, words - w);
+}
+
+/** @brief AVX2 one-vs-many kernel. */
+__attribute__((target("avx2,popcnt"))) inline void
+hamming_distances_avx2(popc::dataset::word_type const *query,
+                       popc::dataset::word_type const *points, std::size_t words,
+                       std::size_t count, std::size_t *out) noexcept {
+  if (words < min_vector_hamming_words) {
+    for (std::size_t c = 0; c < count; ++c) {
+      out[c] = hamming_distance_popcnt(query, points + c * words, words);
+    }
+    return;
+  }
+  for (std::size_t c = 0; c < count; ++c) {
+    out[c] = hamming_distance_avx2(query, points + c * words, words);
+  }
+}
+
+/** @brief AVX-512 VPOPCNTDQ kernel: eight words per step, the tail under a mask. */
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt"))) inline std::size_t
+hamming_distance_avx512(popc::dataset::word_type const *a, popc::dataset::word_type const *b,
+                        std::size_t words) noexcept {
+  if (words < min_vector_hamming_words) {
+    return hamming_distance_popcnt(a, b, words);
+  }
+  __m512i total = _mm512_setzero_si512();
+  std::size_t w = 0;
+  for (; w + 8 <= words; w += 8) {
+    __m512i const x = _mm512_xor_si512(_mm512_loadu_si512(a + w), _mm512_loadu_si512(b + w));
+    total = _mm512_add_epi64(total, _mm512_popcnt_epi64(x));
+  }
+  if (w < words) {
+    auto const mask = static_cast<__mmask8>((1U << (words - w)) - 1);
+    __m512i const x = _mm512_xor_si512(_mm512_maskz_loadu_epi64(mask, a + w),
+                                       _mm512_maskz_loadu_epi64(mask, b + w));
+    total = _mm512_add_epi64(total, _mm512_popcnt_epi64(x));
+  }
+  // Fold the lanes pairwise in registers. The zero-masked shuffles are used
+  // because GCC warns about the undefined source of the unmasked ones, and
+  // of _mm512_reduce_add_epi64 and the casts to narrower vectors.
+  total = _mm512_add_epi64(total, _mm512_maskz_shuffle_i64x2(0xFF, total, total, 0x4E));
+  total = _mm512_add_epi64(total, _mm512_maskz_shuffle_i64x2(0xFF, total, total, 0xB1));
+  total = _mm512_add_epi64(total, _mm512_maskz_unpackhi_epi64(0xFF, total, total));
+  return static_cast<std::size_t>(total[0]);
+}
+
+/** @brief AVX-512 VPOPCNTDQ one-vs-many kernel. */
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt"))) inline void
+hamming_distances_avx512(popc::dataset::word_type const *query,
+                         popc::dataset::word_type const *points, std::size_t words,
+                         std::size_t count, std::size_t *out) noexcept {
+  if (words < min_vector_hamming_words) {
+    for (std::size_t c = 0; c < count; ++c) {
+      out[c] = hamming_distance_popcnt(query, points + c * words, words);
+    }
+    return;
+  }
+  for (std::size_t c = 0; c < count; ++c) {
+    out[c] = hamming_distance_avx512(query, points + c * words, words);
+  }
+}
+
+#endif // POPC_HAMMING_X86
+
+/** @brief A matching pair of Hamming kernels. */
+struct hamming_kernels {
+  hamming_distance_fn distance;
+  hamming_distances_fn distances;
+};
+
+/**
+ * @brief Pick the fastest Hamming kernels the running CPU supports.
+ *
+ * Resolved once per process: AVX-512 VPOPCNTDQ when available, otherwise
+ * AVX2 with POPCNT, otherwise the portable scalar kernels. Every kernel
+ * returns the same distances.
+ */
+[[nodiscard]] inline hamming_kernels select_hamming_kernels() noexcept {
+#ifdef POPC_HAMMING_X86
+  static hamming_kernels const selected = [] {
+    if (__builtin_cpu_supports("avx512vpopcntdq")) {
+      return hamming_kernels{hamming_distance_avx512, hamming_distances_avx512};
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+      return hamming_kernels{hamming_distance_avx2, hamming_distances_avx2};
+    }
+    return hamming_kernels{hamming_distance_scalar, hamming_distances_scalar};
+  }();
+  return selected;
+#else
+  return {hamming_distance_scalar, hamming_distances_scalar};
+#endif
+}
+
+/**
+ * @brief Hamming distance between two bitpacked vectors of equal word length.
+ *
+ * Runs the kernel select_hamming_kernels() picks. The two spans must have
+ * the same length; the function does not check.
+ *
+ * @param a First operand.
+ * @param b Second operand. Must have the same size as `a`.
+ * @return Number of bit positions where `a` and `b` differ.
+ */
+[[nodiscard]] inline std::size_t
+hamming_distance(std::span<popc::dataset::word_type const> a,
+                 std::span<popc::dataset::word_type const> b) noexcept {
+  return select_hamming_kernels().distance(a.data(), b.data(), a.size());
+}
+
+/**
+ * @brief Hamming distances from one vector to a block of vectors.
+ *
+ * @param query  Vector of `query.size()` words.
+ * @param points `out.size()` vectors of `query.size()` words each, stored
+ *               back to back.
+ * @param out    Receives the distance from `query` to each vector.
+ */
+inline void hamming_distances(std::span<popc::dataset::word_type const> query,
+                              std::span<popc::dataset::word_type const> points,
+                              std::span<std::size_t> out) noexcept {
+  select_hamming_kernels().distances(query.data(), points.data(), query.size(), out.size(),
+                                     out.data());
+}
+
+} // namespace popc::detail
+
+#endif // POPC_DETAIL_HAMMING_HPP
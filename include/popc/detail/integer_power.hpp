@@ -0,0 +1,246 @@
+#ifndef POPC_DETAIL_INTEGER_POWER_HPP
+#define POPC_DETAIL_INTEGER_POWER_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "approx_power.hpp"
+
+namespace popc::detail {
+
+/** @brief Largest exponent power_function evaluates by repeated squaring. */
+inline constexpr unsigned max_integer_power = 64;
+
+/** @brief Largest exponent with a row kernel unrolled at compile time. */
+inline constexpr unsigned max_unrolled_power = 16;
+
+/**
+ * @brief Raise `base` to the constant power `P` by repeated squaring.
+ *
+ * Computes `base^(P / 2)` once, squares it and multiplies by `base` when
+ * `P` is odd: `bit_width(P) + popcount(P) - 2` multiplications, fully
+ * unrolled. Bit-identical to the runtime overload for the same `P`.
+ */
+template <unsigned P, typename fptype>
+[[nodiscard]] constexpr fptype integer_pow(fptype base) noexcept {
+  if constexpr (P == 0) {
+    return 1;
+  } else if constexpr (P == 1) {
+    return base;
+  } else {
+    fptype const half = integer_pow<P / 2>(base);
+    if constexpr (P % 2 == 0) {
+      return half * half;
+    } else {
+      return half * half * base;
+    }
+  }
+}
+
+/**
+ * @brief Raise `base` to `power` by repeated squaring.
+ *
+ * Walks the bits of `power` from the most significant, squaring for
+ * every bit and multiplying by `base` for every set one, which performs
+ * the same multiplications in the same order as the compile-time overload.
+ */
+template <typename fptype>
+[[nodiscard]] constexpr fptype integer_pow(fptype base, unsigned power) noexcept {
+  if (power == 0) {
+    return 1;
+  }
+  unsigned bit = 1;
+  while (bit <= power / 2) {
+    bit <<= 1;
+  }
+  fptype result = base;
+  for (bit >>= 1; bit != 0; bit >>= 1) {
+    result *= result;
+    if ((power & bit) != 0) {
+      result *= base;
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Signature of a power-table row kernel.
+ *
+ * Sets `row[c] = ((c * multiplier + 1) / denom)^P` for every `c` in
+ * `[0, length)`, for the kernel's power `P`.
+ */
+template <typename fptype>
+using power_row_fn = void (*)(fptype *row, std::size_t length, fptype multiplier, fptype denom,
+                              fptype power);
+
+/** @brief Row kernel calling `std::pow`; the only one for non-integral powers. */
+template <typename fptype>
+inline void power_row_pow(fptype *row, std::size_t length, fptype multiplier, fptype denom,
+                          fptype power) {
+  for (std::size_t c = 0; c < length; ++c) {
+    row[c] = std::pow((static_cast<fptype>(c) * multiplier + 1) / denom, power);
+  }
+}
+
+/** @brief Row kernel for an integral power beyond max_unrolled_power. */
+template <typename fptype>
+inline void power_row_integer(fptype *row, std::size_t length, fptype multiplier, fptype denom,
+                              fptype power) {
+  auto const exponent = static_cast<unsigned>(power);
+  for (std::size_t c = 0; c < length; ++c) {
+    row[c] = integer_pow((static_cast<fptype>(c) * multiplier + 1) / denom, exponent);
+  }
+}
+
+/** @brief Row kernel for the constant power `P`, unrolled at compile time. */
+template <unsigned P, typename fptype>
+inline void power_row_unrolled(fptype *row, std::size_t length, fptype multiplier, fptype denom,
+                               fptype /*power*/) {
+  for (std::size_t c = 0; c < length; ++c) {
+    row[c] = integer_pow<P>((static_cast<fptype>(c) * multiplier + 1) / denom);
+  }
+}
+
+/** @brief The unrolled row kernels for powers `P...`, indexed by power. */
+template <typename fptype, unsigned... P>
+[[nodiscard]] constexpr std::array<power_row_fn<fptype>, sizeof...(P)>
+unrolled_power_rows(std::integer_sequence<unsigned, P...> /*powers*/) noexcept {
+  return {power_row_unrolled<P, fptype>...};
+}
+
+/** @brief Tag selecting the approx_pow() evaluation of power_function. */
+struct approximate_power_t {
+  explicit approximate_power_t() = default;
+};
+
+/** @brief Tag value selecting the approx_pow() evaluation of power_function. */
+inline constexpr approximate_power_t approximate_power{};
+
+/**
+ * @brief The `p^P` evaluation shared by every delta and power-table row.
+ *
+ * By default calls `std::pow`. With `integral`, evaluates `p^P` by
+ * repeated squaring instead, which costs a handful of multiplications
+ * rather than a transcendental call; table rows for powers up to
+ * max_unrolled_power are filled by kernels unrolled for that power.
+ * Squaring rounds differently from `std::pow`, so the two modes agree
+ * only to within a few units in the last place. The approximate mode
+ * evaluates approx_pow() with vectorized row kernels and is further off
+ * still. Every evaluation through one power_function is consistent with
+ * every other.
+ *
+ * @tparam fptype Floating-point type of the probability arithmetic.
+ */
+template <typename fptype> class power_function {
+public:
+  /**
+   * @brief Choose how to evaluate `p^power`.
+   *
+   * @param power    The `P` hyperparameter.
+   * @param integral Evaluate by repeated squaring; `power` must then be an
+   *                 integer in `[0, max_integer_power]`.
+   *
+   * @throws std::logic_error if `integral` is set and `power` is not an
+   *         integer in `[0, max_integer_power]`.
+   */
+  explicit power_function(fptype power, bool integral = false)
+      : power_{power}, integral_{integral}, fill_{power_row_pow<fptype>} {
+    if (!integral) {
+      return;
+    }
+    if (!(power >= 0 && power <= static_cast<fptype>(max_integer_power)) ||
+        power != std::floor(power)) {
+      throw std::logic_error{"integer power requires an integral power in [0, " +
+                             std::to_string(max_integer_power) + "]"};
+    }
+    exponent_ = static_cast<unsigned>(power);
+    if (exponent_ <= max_unrolled_power) {
+      fill_ = unrolled_power_rows<fptype>(
+          std::make_integer_sequence<unsigned, max_unrolled_power + 1>{})[exponent_];
+    } else {
+      fill_ = power_row_integer<fptype>;
+    }
+  }
+
+  /**
+   * @brief Evaluate `p^power` with approx_pow().
+   *
+   * @param tag   popc::detail::approximate_power.
+   * @param power The `P` hyperparameter.
+   *
+   * @throws std::logic_error if `power` is negative or not finite.
+   */
+  power_function(approximate_power_t /*tag*/, fptype power)
+      : power_{power}, integral_{false}, approximate_{true},
+        fill_{approx_power_row<fptype>} {
+    if (!(power >= 0 && power <= std::numeric_limits<fptype>::max())) {
+      throw std::logic_error{"approximate power requires a finite, non-negative power"};
+    }
+  }
+
+  /** @brief Return the `P` hyperparameter. */
+  [[nodiscard]] fptype power() const noexcept { return power_; }
+
+  /** @brief Return whether `p^P` is evaluated by repeated squaring. */
+  [[nodiscard]] bool integral() const noexcept { return integral_; }
+
+  /** @brief Return whether `p^P` is evaluated by approx_pow(). */
+  [[nodiscard]] bool approximate() const noexcept { return approximate_; }
+
+  /** @brief Return `base^P`. */
+  [[nodiscard]] fptype operator()(fptype base) const {
+    if (integral_) {
+      return integer_pow(base, exponent_);
+    }
+    if (approximate_) {
+      return approx_pow(base, power_);
+    }
+    return std::pow(base, power_);
+  }
+
+  /**
+   * @brief Fill a power-table row.
+   *
+   * Sets `row[c] = ((c * multiplier + 1) / denom)^P` for every `c`, each
+   * entry bit-identical to `(*this)` of the same probability.
+   */
+  void fill(std::span<fptype> row, fptype multiplier, fptype denom) const {
+    fill_(row.data(), row.size(), multiplier, denom, power_);
+  }
+
+  /**
+   * @brief Bound the relative error of one term in units of epsilon.
+   *
+   * `std::pow` is within one unit in the last place. Each of the at most
+   * `P - 1` multiplications of repeated squaring adds half a unit, and the
+   * relative errors of the factors add up, so `P - 1` units bound it.
+   * approx_pow() is within `4P + 8` units for probabilities near one; its
+   * bound grows for smaller ones, so this figure is only nominal there.
+   */
+  [[nodiscard]] fptype error_ulps() const noexcept {
+    if (approximate_) {
+      return 4 * power_ + 8;
+    }
+    if (!integral_ || exponent_ < 2) {
+      return 1;
+    }
+    return static_cast<fptype>(exponent_ - 1);
+  }
+
+private:
+  fptype power_;
+  bool integral_;
+  bool approximate_{false};
+  unsigned exponent_{};
+  power_row_fn<fptype> fill_;
+};
+
+} // namespace popc::detail
+
+#endif // POPC_DETAIL_INTEGER_POWER_HPP
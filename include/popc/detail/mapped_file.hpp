@@ -0,0 +1,115 @@
+#ifndef POPC_DETAIL_MAPPED_FILE_HPP
+#define POPC_DETAIL_MAPPED_FILE_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace popc::detail {
+
+/**
+ * @brief Read-only memory mapping of a whole regular file (POSIX).
+ *
+ * Maps the file with `mmap(PROT_READ, MAP_PRIVATE)` and advises the kernel
+ * of sequential access, so a parser can scan the contents as one
+ * contiguous buffer without any per-character stream calls. The file
+ * descriptor is closed right after mapping; the mapping itself lives until
+ * the object is destroyed.
+ *
+ * Only regular files can be mapped. Pipes, sockets, and terminals must be
+ * read through the `std::istream` path of popc::dataset instead.
+ */
+class mapped_file {
+public:
+  /**
+   * @brief Map the file at `path`.
+   *
+   * An empty file yields an empty view without creating a mapping.
+   *
+   * @param path Null-terminated path to a regular file.
+   *
+   * @throws std::system_error if the file cannot be opened, is not a
+   *         regular file, or cannot be mapped.
+   */
+  explicit mapped_file(char const *path) {
+    int const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::system_error{errno, std::generic_category(), std::string{"open "} + path};
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+      int const err = errno;
+      ::close(fd);
+      throw std::system_error{err, std::generic_category(), std::string{"stat "} + path};
+    }
+    if (!S_ISREG(st.st_mode)) {
+      ::close(fd);
+      throw std::system_error{EINVAL, std::generic_category(),
+                              std::string{"not a regular file: "} + path};
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ != 0) {
+      void *const addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr == MAP_FAILED) {
+        int const err = errno;
+        ::close(fd);
+        throw std::system_error{err, std::generic_category(), std::string{"mmap "} + path};
+      }
+      data_ = addr;
+      ::madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+  }
+
+  mapped_file(mapped_file const &) = delete;
+  mapped_file &operator=(mapped_file const &) = delete;
+
+  /** @brief Transfer ownership of the mapping. */
+  mapped_file(mapped_file &&other) noexcept
+      : data_{std::exchange(other.data_, nullptr)}, size_{std::exchange(other.size_, 0)} {}
+
+  /** @brief Transfer ownership of the mapping, unmapping the current one. */
+  mapped_file &operator=(mapped_file &&other) noexcept {
+    if (this != &other) {
+      unmap();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+
+  /** @brief Unmap the file. */
+  ~mapped_file() { unmap(); }
+
+  /** @brief Return the mapped bytes as a character view. */
+  [[nodiscard]] std::string_view view() const noexcept {
+    return {static_cast<char const *>(data_), size_};
+  }
+
+  /** @brief Return the size of the mapped file in bytes. */
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+private:
+  void unmap() noexcept {
+    if (data_ != nullptr) {
+      ::munmap(data_, size_);
+      data_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+  void *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+} // namespace popc::detail
+
+#endif // POPC_DETAIL_MAPPED_FILE_HPP
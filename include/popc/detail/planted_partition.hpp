@@ -0,0 +1,258 @@
+#ifndef POPC_DETAIL_PLANTED_PARTITION_HPP
+#define POPC_DETAIL_PLANTED_PARTITION_HPP
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "../dataset.hpp"
+
+namespace popc::detail {
+
+/** @brief Hyperparameters of a planted_partition model. */
+struct planted_partition_options {
+  /** Attributes per instance (`F`). */
+  std::size_t num_attributes = 100;
+  /** Planted clusters; each instance belongs to one, uniformly at random. */
+  std::size_t num_clusters = 10;
+  /** Probability that an attribute is characteristic of a given cluster. */
+  double density = 0.1;
+  /** Probability that a member has a characteristic attribute set. */
+  double p_in = 0.8;
+  /** Probability that a member has any other attribute set. */
+  double p_out = 0.05;
+  /** Probability that each generated bit is then flipped. */
+  double noise = 0;
+  /** Seed of the model and of every instance drawn from it. */
+  std::uint64_t seed = 1;
+};
+
+/**
+ * @brief Counter-based SplitMix64: a well-mixed 64-bit word for `(key, counter)`.
+ *
+ * Stateless, so every draw that seeds from it (cluster models, labels,
+ * row generators) can be made independently of the others, in any order
+ * and on any thread, with the same result.
+ */
+[[nodiscard]] constexpr std::uint64_t splitmix64(std::uint64_t key,
+                                                 std::uint64_t counter) noexcept {
+  std::uint64_t z = key + (counter + 1) * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * @brief xoshiro256** pseudo-random generator.
+ *
+ * A few shifts, rotations and additions per 64-bit word, several times
+ * cheaper than hashing a counter per word, so it draws the bulk of a row
+ * once splitmix64() has seeded it for that row.
+ */
+class xoshiro256ss {
+public:
+  /** @brief Seed the state with four splitmix64() words of `(key, stream)`. */
+  constexpr xoshiro256ss(std::uint64_t key, std::uint64_t stream) noexcept
+      : s_{splitmix64(key, 4 * stream), splitmix64(key, 4 * stream + 1),
+           splitmix64(key, 4 * stream + 2), splitmix64(key, 4 * stream + 3)} {}
+
+  /** @brief Return the next 64-bit word. */
+  constexpr std::uint64_t operator()() noexcept {
+    std::uint64_t const result = std::rotl(s_[1] * 5, 7) * 9;
+    std::uint64_t const t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = std::rotl(s_[3], 45);
+    return result;
+  }
+
+private:
+  std::uint64_t s_[4];
+};
+
+/**
+ * @brief Synthetic binary data with a known planted partition.
+ *
+ * Every cluster marks each attribute as characteristic with probability
+ * `density`; a member of the cluster then has a characteristic attribute
+ * set with probability `p_in` and any other with probability `p_out`,
+ * and every bit is finally flipped with probability `noise`. Instance `i`
+ * belongs to label(i) and its row depends only on the options and `i`.
+ *
+ * Bits are drawn 64 at a time. Each probability is rounded to a multiple
+ * `q / 2^probability_bits`, and a bit is set when a uniform
+ * probability_bits-digit number `u` is below `q`. The digits of `u` for
+ * 64 lanes come from one random word each, most significant first; a
+ * lane is decided at the first digit where `u` and `q` differ. Half the
+ * undecided lanes settle with every word, so eager_digits words are drawn
+ * without a check and the rest only while some lane is undecided: about
+ * eight words per 64 attributes rather than probability_bits, whatever
+ * the probabilities. Each row has its own generator, seeded from its
+ * index.
+ */
+class planted_partition {
+public:
+  using word_type = popc::dataset::word_type;
+  static constexpr std::size_t bits_per_word = popc::dataset::bits_per_word;
+
+  /** @brief Binary digits to which each probability is rounded. */
+  static constexpr unsigned probability_bits = 16;
+
+  /**
+   * @brief Digits always drawn, without checking whether every lane is decided.
+   *
+   * All 64 lanes are decided after eight digits in most words, and an
+   * unconditional run of them avoids a mispredicted loop exit per word.
+   */
+  static constexpr unsigned eager_digits = 8;
+
+  /**
+   * @brief Draw the clusters' characteristic attributes.
+   *
+   * @param opts Model hyperparameters.
+   *
+   * @throws std::logic_error if there are no attributes or no clusters, or
+   *         if `density`, `p_in`, `p_out` or `noise` is outside `[0, 1]`.
+   */
+  explicit planted_partition(planted_partition_options const &opts)
+      : opts_{opts},
+        words_per_instance_{(opts.num_attributes + bits_per_word - 1) / bits_per_word} {
+    if (opts.num_attributes == 0 || opts.num_clusters == 0) {
+      throw std::logic_error{"planted partition needs at least one attribute and one cluster"};
+    }
+    for (double const p : {opts.density, opts.p_in, opts.p_out, opts.noise}) {
+      if (!(p >= 0 && p <= 1)) {
+        throw std::logic_error{"planted partition probabilities must lie in [0, 1]"};
+      }
+    }
+    std::uint32_t const q_in =
+        quantize(opts.p_in * (1 - opts.noise) + (1 - opts.p_in) * opts.noise);
+    std::uint32_t const q_out =
+        quantize(opts.p_out * (1 - opts.noise) + (1 - opts.p_out) * opts.noise);
+    std::uint32_t const q_density = quantize(opts.density);
+
+    planes_.assign(opts.num_clusters * words_per_instance_ * (probability_bits + 1), 0);
+    for (std::size_t c = 0; c < opts.num_clusters; ++c) {
+      for (std::size_t j = 0; j < opts.num_attributes; ++j) {
+        auto const draw = static_cast<std::uint32_t>(
+            splitmix64(model_key(), c * opts.num_attributes + j) >> (64 - probability_bits));
+        std::uint32_t const q = draw < q_density ? q_in : q_out;
+        word_type *const plane = plane_words(c, j / bits_per_word);
+        word_type const bit = word_type{1} << (j % bits_per_word);
+        for (unsigned k = 0; k <= probability_bits; ++k) {
+          if (((q >> k) & 1U) != 0) {
+            plane[k] |= bit;
+          }
+        }
+      }
+    }
+  }
+
+  /** @brief Return the options the model was built from. */
+  [[nodiscard]] planted_partition_options const &options() const noexcept { return opts_; }
+
+  /** @brief Return the number of attributes per instance. */
+  [[nodiscard]] std::size_t num_attributes() const noexcept { return opts_.num_attributes; }
+
+  /** @brief Return the number of planted clusters. */
+  [[nodiscard]] std::size_t num_clusters() const noexcept { return opts_.num_clusters; }
+
+  /** @brief Return the number of 64-bit words of one row. */
+  [[nodiscard]] std::size_t words_per_instance() const noexcept { return words_per_instance_; }
+
+  /** @brief Return the planted cluster of instance `i`. */
+  [[nodiscard]] std::size_t label(std::uint64_t i) const noexcept {
+    return static_cast<std::size_t>(splitmix64(label_key(), i) % opts_.num_clusters);
+  }
+
+  /**
+   * @brief Return the probability that a member of `cluster` has `attribute_num` set.
+   *
+   * This is the rounded probability the rows are actually drawn with,
+   * noise included.
+   */
+  [[nodiscard]] double probability(std::size_t cluster, std::size_t attribute_num) const noexcept {
+    word_type const *const plane = plane_words(cluster, attribute_num / bits_per_word);
+    std::uint32_t q = 0;
+    for (unsigned k = 0; k <= probability_bits; ++k) {
+      q |= static_cast<std::uint32_t>((plane[k] >> (attribute_num % bits_per_word)) & 1U) << k;
+    }
+    return std::ldexp(static_cast<double>(q), -static_cast<int>(probability_bits));
+  }
+
+  /**
+   * @brief Generate the row of instance `i`.
+   *
+   * @param i   Instance index.
+   * @param row Receives words_per_instance() words in the popc::dataset
+   *            row layout; padding bits are zero.
+   * @return label(i).
+   */
+  std::size_t generate(std::uint64_t i, std::span<word_type> row) const noexcept {
+    std::size_t const cluster = label(i);
+    xoshiro256ss rng{row_key(), i};
+    for (std::size_t w = 0; w < words_per_instance_; ++w) {
+      word_type const *const plane = plane_words(cluster, w);
+      word_type bits = 0;
+      word_type undecided = ~word_type{0};
+      unsigned k = probability_bits;
+      auto const step = [&] {
+        --k;
+        word_type const r = rng();
+        bits |= undecided & ~r & plane[k];
+        undecided &= ~(r ^ plane[k]);
+      };
+      for (unsigned s = 0; s < eager_digits; ++s) {
+        step();
+      }
+      while (undecided != 0 && k != 0) {
+        step();
+      }
+      row[w] = bits | plane[probability_bits];
+    }
+    if (std::size_t const tail = opts_.num_attributes % bits_per_word; tail != 0) {
+      row[words_per_instance_ - 1] &= (word_type{1} << tail) - 1;
+    }
+    return cluster;
+  }
+
+private:
+  /** @brief Round `p` to a multiple of `2^-probability_bits`, as an integer. */
+  [[nodiscard]] static std::uint32_t quantize(double p) noexcept {
+    return static_cast<std::uint32_t>(
+        std::lround(std::ldexp(p, static_cast<int>(probability_bits))));
+  }
+
+  [[nodiscard]] std::uint64_t model_key() const noexcept { return splitmix64(opts_.seed, 0); }
+  [[nodiscard]] std::uint64_t label_key() const noexcept { return splitmix64(opts_.seed, 1); }
+  [[nodiscard]] std::uint64_t row_key() const noexcept { return splitmix64(opts_.seed, 2); }
+
+  /**
+   * @brief Return the digit planes of one word of a cluster's probabilities.
+   *
+   * Plane `k < probability_bits` has a lane's bit set when digit `k` of
+   * its rounded probability `q` is one; plane `probability_bits` marks the
+   * probabilities that round to one, whose digits are all zero.
+   */
+  [[nodiscard]] word_type *plane_words(std::size_t cluster, std::size_t w) noexcept {
+    return planes_.data() + (cluster * words_per_instance_ + w) * (probability_bits + 1);
+  }
+  [[nodiscard]] word_type const *plane_words(std::size_t cluster, std::size_t w) const noexcept {
+    return planes_.data() + (cluster * words_per_instance_ + w) * (probability_bits + 1);
+  }
+
+  planted_partition_options opts_;
+  std::size_t words_per_instance_;
+  std::vector<word_type> planes_;
+};
+
+} // namespace popc::detail
+
+#endif // POPC_DETAIL_PLANTED_PARTITION_HPP
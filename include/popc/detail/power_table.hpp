@@ -0,0 +1,146 @@
+#ifndef POPC_DETAIL_POWER_TABLE_HPP
+#define POPC_DETAIL_POWER_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../dataset.hpp"
+#include "integer_power.hpp"
+
+namespace popc::detail {
+
+/**
+ * @brief Per-attribute lookup table of powered POPC probabilities.
+ *
+ * For attribute `j`, the probability term of the POPC objective depends
+ * only on the cluster-local count `c`, the dataset-wide count
+ * `positive_count(j)` and the current number of clusters `N`:
+ * `p(c) = (c * Cm + 1) / (positive_count(j) * Cm + N)`. A cluster-local
+ * count is bounded by the dataset-wide one, so row `j` of the table holds
+ * `p(c)^P` for every `c` in `[0, positive_count(j)]`, and the whole table
+ * has `nnz + num_attributes` entries.
+ *
+ * Entries are computed with the exact expression popc::compute_delta()
+ * uses (the same power_function of the same operands), so table-driven
+ * deltas are bit-identical to the direct path for every count that
+ * `fptype` represents exactly.
+ *
+ * Rows are invalidated when `N` changes and refilled lazily on first use
+ * after that. An eager rebuild of the whole table on every cluster
+ * removal would cost `nnz + F` powers per removal; early in popc::popc(),
+ * when removals are frequent, that can exceed the powers it saves.
+ *
+ * @tparam fptype Floating-point type of the probability arithmetic.
+ */
+template <typename fptype> class power_table {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * @brief Size an empty table for a dataset.
+   *
+   * @param ds         Dataset providing the per-attribute positive counts.
+   *                   Must outlive the table.
+   * @param multiplier The `Cm` hyperparameter.
+   * @param power      The `P` hyperparameter.
+   * @param integral   Fill rows by repeated squaring; see power_function.
+   *
+   * @throws std::logic_error if `integral` is set and `power` is not a
+   *         small enough non-negative integer.
+   */
+  power_table(popc::dataset const &ds, fptype multiplier, fptype power, bool integral = false)
+      : power_table(ds, multiplier, power_function<fptype>{power, integral}) {}
+
+  /**
+   * @brief Size an empty table whose rows are filled by `raise`.
+   *
+   * @param ds         Dataset providing the per-attribute positive counts.
+   *                   Must outlive the table.
+   * @param multiplier The `Cm` hyperparameter.
+   * @param raise      How entries are computed.
+   */
+  power_table(popc::dataset const &ds, fptype multiplier, power_function<fptype> const &raise)
+      : ds_{&ds}, multiplier_{multiplier}, raise_{raise}, offsets_(ds.num_attributes() + 1, 0),
+        row_generation_(ds.num_attributes(), 0) {
+    for (size_type j = 0; j < ds.num_attributes(); ++j) {
+      offsets_[j + 1] = offsets_[j] + ds.positive_count(j) + 1;
+    }
+    values_.resize(offsets_.back());
+  }
+
+  /** @brief Return the `Cm` hyperparameter the table was built with. */
+  [[nodiscard]] fptype multiplier() const noexcept { return multiplier_; }
+
+  /** @brief Return the `P` hyperparameter the table was built with. */
+  [[nodiscard]] fptype power() const noexcept { return raise_.power(); }
+
+  /** @brief Return how the entries are computed. */
+  [[nodiscard]] power_function<fptype> const &raise() const noexcept { return raise_; }
+
+  /**
+   * @brief Compute entries with `raise` from now on.
+   *
+   * Invalidates every row; `raise` must have the table's power.
+   */
+  void set_raise(power_function<fptype> const &raise) noexcept {
+    raise_ = raise;
+    ++generation_;
+  }
+
+  /** @brief Return the number of clusters the rows are currently valid for. */
+  [[nodiscard]] size_type num_clusters() const noexcept { return num_clusters_; }
+
+  /**
+   * @brief Set the current number of clusters `N`.
+   *
+   * Invalidates every row when `num_clusters` differs from the previous
+   * value; a no-op otherwise.
+   *
+   * @param num_clusters Current partition size.
+   */
+  void set_num_clusters(size_type num_clusters) noexcept {
+    if (num_clusters != num_clusters_) {
+      num_clusters_ = num_clusters;
+      ++generation_;
+    }
+  }
+
+  /**
+   * @brief Return the row of powered probabilities for one attribute.
+   *
+   * Fills the row first if it is stale for the current `N`. A fresh row
+   * is only read, so once every row a computation needs has been touched
+   * at the current `N`, concurrent calls for those rows are safe.
+   *
+   * @param attribute_num Zero-based attribute index.
+   * @return Span of `positive_count(attribute_num) + 1` entries; entry `c`
+   *         holds `p(c)^P`.
+   */
+  [[nodiscard]] std::span<fptype const> row(size_type attribute_num) {
+    fptype *const first = values_.data() + offsets_[attribute_num];
+    size_type const length = offsets_[attribute_num + 1] - offsets_[attribute_num];
+    if (row_generation_[attribute_num] != generation_) {
+      auto const counts_all = static_cast<fptype>(ds_->positive_count(attribute_num));
+      fptype const denom = counts_all * multiplier_ + static_cast<fptype>(num_clusters_);
+      raise_.fill({first, length}, multiplier_, denom);
+      row_generation_[attribute_num] = generation_;
+    }
+    return {first, length};
+  }
+
+private:
+  popc::dataset const *ds_;
+  fptype multiplier_;
+  power_function<fptype> raise_;
+  size_type num_clusters_{};
+  std::uint64_t generation_{1};
+  std::vector<size_type> offsets_;
+  std::vector<fptype> values_;
+  std::vector<std::uint64_t> row_generation_;
+};
+
+} // namespace popc::detail
+
+#endif // POPC_DETAIL_POWER_TABLE_HPP
@@ -0,0 +1,205 @@
+#ifndef POPC_DETAIL_ROW_DECODER_HPP
+#define POPC_DETAIL_ROW_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define POPC_ROW_DECODER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace popc::detail {
+
+/**
+ * @brief Gather the even-numbered bits of a 64-bit mask into 32 bits.
+ *
+ * Bit `2k` of `x` becomes bit `k` of the result; odd bits are discarded.
+ * Portable replacement for `pext(x, 0x5555...)`, which is microcoded and
+ * slow on several x86 generations.
+ */
+[[nodiscard]] constexpr std::uint32_t compress_even_bits(std::uint64_t x) noexcept {
+  x &= 0x5555555555555555ULL;
+  x = (x | (x >> 1U)) & 0x3333333333333333ULL;
+  x = (x | (x >> 2U)) & 0x0F0F0F0F0F0F0F0FULL;
+  x = (x | (x >> 4U)) & 0x00FF00FF00FF00FFULL;
+  x = (x | (x >> 8U)) & 0x0000FFFF0000FFFFULL;
+  x = (x | (x >> 16U)) & 0x00000000FFFFFFFFULL;
+  return static_cast<std::uint32_t>(x);
+}
+
+/**
+ * @brief Validate and pack one 64-byte chunk given its classification masks.
+ *
+ * Bit `k` of each mask describes byte `k` of the chunk. A well-formed
+ * chunk holds 32 `value, delimiter` pairs: every even byte is `'0'` or
+ * `'1'` and every odd byte is the delimiter.
+ *
+ * @return `true` if the chunk is well formed; `bits` then receives the 32
+ *         attribute values, attribute `k` in bit `k`.
+ */
+[[nodiscard]] constexpr bool pack_chunk(std::uint64_t ones, std::uint64_t zeros,
+                                        std::uint64_t delimiters, std::uint32_t &bits) noexcept {
+  constexpr std::uint64_t even = 0x5555555555555555ULL;
+  constexpr std::uint64_t odd = ~even;
+  bits = compress_even_bits(ones);
+  return ((ones | zeros) & even) == even && (delimiters & odd) == odd;
+}
+
+/**
+ * @brief Signature shared by the chunk decoder kernels.
+ *
+ * Decodes `num_chunks` consecutive 64-byte chunks starting at `p` into
+ * `words` (32 attributes per chunk, chunk `m` filling half `m % 2` of word
+ * `m / 2`). `words` must be zeroed beforehand. Returns `false` as soon as a
+ * malformed chunk is found; `words` is then partially written.
+ */
+using decode_chunks_fn = bool (*)(char const *p, std::size_t num_chunks, char delimiter,
+                                  std::uint64_t *words) noexcept;
+
+/** @brief Portable chunk decoder: classifies one byte at a time. */
+inline bool decode_chunks_scalar(char const *p, std::size_t num_chunks, char delimiter,
+                                 std::uint64_t *words) noexcept {
+  for (std::size_t m = 0; m < num_chunks; ++m, p += 64) {
+    std::uint64_t ones = 0;
+    std::uint64_t zeros = 0;
+    std::uint64_t delimiters = 0;
+    for (unsigned k = 0; k < 64; ++k) {
+      ones |= static_cast<std::uint64_t>(p[k] == '1') << k;
+      zeros |= static_cast<std::uint64_t>(p[k] == '0') << k;
+      delimiters |= static_cast<std::uint64_t>(p[k] == delimiter) << k;
+    }
+    std::uint32_t bits = 0;
+    if (!pack_chunk(ones, zeros, delimiters, bits)) {
+      return false;
+    }
+    words[m / 2] |= static_cast<std::uint64_t>(bits) << (32U * (m % 2));
+  }
+  return true;
+}
+
+#ifdef POPC_ROW_DECODER_X86
+
+/** @brief SSE2 chunk decoder (x86-64 baseline): four 16-byte compares per mask. */
+inline bool decode_chunks_sse2(char const *p, std::size_t num_chunks, char delimiter,
+                               std::uint64_t *words) noexcept {
+  __m128i const one = _mm_set1_epi8('1');
+  __m128i const zero = _mm_set1_epi8('0');
+  __m128i const delim = _mm_set1_epi8(delimiter);
+  for (std::size_t m = 0; m < num_chunks; ++m, p += 64) {
+    std::uint64_t ones = 0;
+    std::uint64_t zeros = 0;
+    std::uint64_t delimiters = 0;
+    for (unsigned q = 0; q < 4; ++q) {
+      __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p + 16 * q));
+      unsigned const shift = 16 * q;
+      ones |= static_cast<std::uint64_t>(
+                  static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, one))))
+              << shift;
+      zeros |= static_cast<std::uint64_t>(
+                   static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero))))
+               << shift;
+      delimiters |= static_cast<std::uint64_t>(
+                        static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, delim))))
+                    << shift;
+    }
+    std::uint32_t bits = 0;
+    if (!pack_chunk(ones, zeros, delimiters, bits)) {
+      return false;
+    }
+    words[m / 2] |= static_cast<std::uint64_t>(bits) << (32U * (m % 2));
+  }
+  return true;
+}
+
+/** @brief AVX2 chunk decoder: two 32-byte compares per mask. */
+__attribute__((target("avx2"))) inline bool decode_chunks_avx2(char const *p,
+                                                               std::size_t num_chunks,
+                                                               char delimiter,
+                                                               std::uint64_t *words) noexcept {
+  __m256i const one = _mm256_set1_epi8('1');
+  __m256i const zero = _mm256_set1_epi8('0');
+  __m256i const delim = _mm256_set1_epi8(delimiter);
+  auto const mask = [](__m256i v) __attribute__((target("avx2"))) {
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(v)));
+  };
+  for (std::size_t m = 0; m < num_chunks; ++m, p += 64) {
+    __m256i const lo = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+    __m256i const hi = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p + 32));
+    std::uint64_t const ones =
+        mask(_mm256_cmpeq_epi8(lo, one)) | (mask(_mm256_cmpeq_epi8(hi, one)) << 32U);
+    std::uint64_t const zeros =
+        mask(_mm256_cmpeq_epi8(lo, zero)) | (mask(_mm256_cmpeq_epi8(hi, zero)) << 32U);
+    std::uint64_t const delimiters =
+        mask(_mm256_cmpeq_epi8(lo, delim)) | (mask(_mm256_cmpeq_epi8(hi, delim)) << 32U);
+    std::uint32_t bits = 0;
+    if (!pack_chunk(ones, zeros, delimiters, bits)) {
+      return false;
+    }
+    words[m / 2] |= static_cast<std::uint64_t>(bits) << (32U * (m % 2));
+  }
+  return true;
+}
+
+#endif // POPC_ROW_DECODER_X86
+
+/**
+ * @brief Pick the widest chunk decoder the running CPU supports.
+ *
+ * Resolved once per process: AVX2 when available, otherwise SSE2 on
+ * x86-64, otherwise the portable scalar kernel.
+ */
+[[nodiscard]] inline decode_chunks_fn select_decode_chunks() noexcept {
+#ifdef POPC_ROW_DECODER_X86
+  static decode_chunks_fn const selected =
+      __builtin_cpu_supports("avx2") ? decode_chunks_avx2 : decode_chunks_sse2;
+  return selected;
+#else
+  return decode_chunks_scalar;
+#endif
+}
+
+/**
+ * @brief Decode one well-formed row of `num_attributes` binary values.
+ *
+ * A well-formed row is exactly `2 * num_attributes` bytes: `value,
+ * delimiter` pairs with the final delimiter replaced by `'\n'`. Full
+ * 32-attribute chunks that end before the last value go through the
+ * selected vector kernel; the remaining 1 to 32 attributes and the
+ * terminating newline are checked one byte at a time.
+ *
+ * This is only the fast path: it reports malformed input by returning
+ * `false` without diagnosing it, so the caller can re-parse the row with
+ * a byte-wise parser that produces a precise error message.
+ *
+ * @param p              First byte of the row; `2 * num_attributes`
+ *                       bytes must be readable.
+ * @param num_attributes Column count; must be at least 1.
+ * @param delimiter      Column separator.
+ * @param words          Zeroed output words for the row.
+ * @return `true` if the row is well formed and `words` holds its bits.
+ */
+[[nodiscard]] inline bool decode_row(char const *p, std::size_t num_attributes, char delimiter,
+                                     std::uint64_t *words) noexcept {
+  std::size_t const num_chunks = (num_attributes - 1) / 32;
+  if (num_chunks != 0 && !select_decode_chunks()(p, num_chunks, delimiter, words)) {
+    return false;
+  }
+  for (std::size_t j = num_chunks * 32; j < num_attributes; ++j) {
+    char const v = p[2 * j];
+    char const sep = p[2 * j + 1];
+    if (v == '1') {
+      words[j / 64] |= std::uint64_t{1} << (j % 64);
+    } else if (v != '0') {
+      return false;
+    }
+    if (sep != (j + 1 == num_attributes ? '\n' : delimiter)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace popc::detail
+
+#endif // POPC_DETAIL_ROW_DECODER_HPP
@@ -0,0 +1,161 @@
+#ifndef POPC_DETAIL_THREAD_POOL_HPP
+#define POPC_DETAIL_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace popc::detail {
+
+/**
+ * @brief Fixed-size pool of worker threads running indexed fork-join loops.
+ *
+ * The only operation is for_each(), which runs `body(k)` for every `k` in
+ * `[0, num_tasks)` and returns once all of them have finished. Tasks are
+ * handed out dynamically through an atomic counter and the calling thread
+ * works alongside the pool, so a pool of size `n` has `n - 1` background
+ * threads. Workers sleep on a condition variable between loops; creating
+ * the pool once and reusing it avoids a thread spawn per loop.
+ *
+ * A pool of size 1 spawns nothing and runs every loop inline on the
+ * calling thread, in task order.
+ */
+class thread_pool {
+public:
+  /**
+   * @brief Start `num_threads - 1` background workers.
+   *
+   * @param num_threads Total number of threads taking part in each loop,
+   *                    including the caller.
+   *
+   * @throws std::logic_error if `num_threads` is zero.
+   */
+  explicit thread_pool(std::size_t num_threads) {
+    if (num_threads == 0) {
+      throw std::logic_error{"thread_pool needs at least one thread"};
+    }
+    workers_.reserve(num_threads - 1);
+    for (std::size_t t = 1; t < num_threads; ++t) {
+      workers_.emplace_back([this] { work(); });
+    }
+  }
+
+  thread_pool(thread_pool const &) = delete;
+  thread_pool &operator=(thread_pool const &) = delete;
+
+  /** @brief Stop and join every background worker. */
+  ~thread_pool() {
+    {
+      std::lock_guard const lock{mutex_};
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /** @brief Return the number of threads taking part in each loop. */
+  [[nodiscard]] std::size_t size() const noexcept { return workers_.size() + 1; }
+
+  /**
+   * @brief Run `body(k)` for every `k` in `[0, num_tasks)` and wait.
+   *
+   * Tasks may run in any order and on any thread; `body` must be safe to
+   * call concurrently for distinct `k`. If any task throws, the remaining
+   * tasks still run and the first exception caught is rethrown here.
+   *
+   * @param num_tasks Number of task indices.
+   * @param body      Callable taking a `std::size_t` task index.
+   */
+  template <typename Body> void for_each(std::size_t num_tasks, Body &&body) {
+    if (workers_.empty() || num_tasks <= 1) {
+      for (std::size_t k = 0; k < num_tasks; ++k) {
+        body(k);
+      }
+      return;
+    }
+    {
+      std::lock_guard const lock{mutex_};
+      body_ = const_cast<void *>(static_cast<void const *>(std::addressof(body)));
+      invoke_ = [](void *b, std::size_t k) {
+        (*static_cast<std::remove_reference_t<Body> *>(b))(k);
+      };
+      num_tasks_ = num_tasks;
+      next_.store(0, std::memory_order_relaxed);
+      busy_ = workers_.size();
+      ++generation_;
+    }
+    wake_.notify_all();
+    drain();
+    std::unique_lock lock{mutex_};
+    done_.wait(lock, [this] { return busy_ == 0; });
+    if (error_) {
+      std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+  }
+
+private:
+  /** @brief Claim and run tasks of the current loop until none are left. */
+  void drain() noexcept {
+    for (std::size_t k = next_.fetch_add(1, std::memory_order_relaxed); k < num_tasks_;
+         k = next_.fetch_add(1, std::memory_order_relaxed)) {
+      try {
+        invoke_(body_, k);
+      } catch (...) {
+        std::lock_guard const lock{mutex_};
+        if (!error_) {
+          error_ = std::current_exception();
+        }
+      }
+    }
+  }
+
+  /** @brief Background worker: wait for a loop, help drain it, report back. */
+  void work() {
+    std::uint64_t seen = 0;
+    while (true) {
+      {
+        std::unique_lock lock{mutex_};
+        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) {
+          return;
+        }
+        seen = generation_;
+      }
+      drain();
+      {
+        std::lock_guard const lock{mutex_};
+        if (--busy_ == 0) {
+          done_.notify_one();
+        }
+      }
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  bool stop_{};
+  std::uint64_t generation_{};
+  std::size_t busy_{};
+  void *body_{};
+  void (*invoke_)(void *, std::size_t){};
+  std::size_t num_tasks_{};
+  std::atomic<std::size_t> next_{};
+  std::exception_ptr error_;
+};
+
+} // namespace popc::detail
+
+#endif // POPC_DETAIL_THREAD_POOL_HPP
@@ -0,0 +1,230 @@
+#ifndef POPC_DETAIL_VP_TREE_HPP
+#define POPC_DETAIL_VP_TREE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "../dataset.hpp"
+#include "hamming.hpp"
+
+namespace popc::detail {
+
+/**
+ * @brief Vantage-point tree answering exact nearest-neighbour queries in Hamming distance.
+ *
+ * Each node holds a vantage point `v` and the median distance `r` from
+ * `v` to the rest of its points: the inside subtree holds points within
+ * `r` of `v` and the outside subtree points at least `r` away. A query
+ * `q` at distance `d` from `v` can only have a neighbour within `best` in
+ * the inside subtree if `d - best <= r`, and in the outside subtree if
+ * `d + best >= r`, by the triangle inequality, so whole subtrees are
+ * skipped once a close neighbour is known. Small subtrees are leaves
+ * scanned linearly.
+ *
+ * The points are copied in tree order, so a query walks them mostly
+ * forward in memory. Building takes `O(k log k)` distance computations
+ * for `k` points; a query takes far fewer than `k` when the points are
+ * clustered, and degrades gracefully towards `k` when they are not.
+ */
+class vp_tree {
+public:
+  using word_type = popc::dataset::word_type;
+
+  /** @brief Subtrees of at most this many points are scanned linearly. */
+  static constexpr std::size_t leaf_size = 8;
+
+  /** @brief Result of a nearest-neighbour query. */
+  struct neighbor {
+    /** Caller's identifier of the point; `max()` when the tree is empty. */
+    std::size_t id = std::numeric_limits<std::size_t>::max();
+    /** Hamming distance from the query; `max()` when the tree is empty. */
+    std::size_t distance = std::numeric_limits<std::size_t>::max();
+  };
+
+  /** @brief Construct an empty tree. */
+  vp_tree() = default;
+
+  /**
+   * @brief Rebuild the tree over a subset of packed points.
+   *
+   * @param points             Packed points, `words_per_instance` words each.
+   * @param words_per_instance Words per point.
+   * @param ids                Indices of the points to index; a query
+   *                           reports these identifiers.
+   */
+  void build(std::span<word_type const> points, std::size_t words_per_instance,
+             std::span<std::size_t const> ids) {
+    wpi_ = words_per_instance;
+    std::size_t const k = ids.size();
+    order_.assign(ids.begin(), ids.end());
+    radius_.assign(k, 0);
+    split_.assign(k, 0);
+    scratch_.resize(k);
+    build_node(points, 0, k);
+
+    points_.resize(k * wpi_);
+    for (std::size_t pos = 0; pos < k; ++pos) {
+      std::copy_n(points.begin() + static_cast<std::ptrdiff_t>(order_[pos] * wpi_), wpi_,
+                  points_.begin() + static_cast<std::ptrdiff_t>(pos * wpi_));
+    }
+  }
+
+  /** @brief Return the number of indexed points. */
+  [[nodiscard]] std::size_t size() const noexcept { return order_.size(); }
+
+  /**
+   * @brief Find the indexed point nearest to `query`.
+   *
+   * Exact: among the points at the minimum distance, the one with the
+   * lowest identifier is returned, as a linear scan in identifier order
+   * keeping the first strict improvement would find.
+   */
+  [[nodiscard]] neighbor nearest(std::span<word_type const> query) const {
+    nearest_one best;
+    search(query, 0, order_.size(), best);
+    return best.first;
+  }
+
+  /**
+   * @brief Find the two indexed points nearest to `query`.
+   *
+   * The first is the one nearest() returns; the second is the nearest of
+   * the others, ties again to the lowest identifier, so its distance is a
+   * lower bound on the distance to every point but the first. It is
+   * default-constructed when fewer than two points are indexed.
+   */
+  [[nodiscard]] std::pair<neighbor, neighbor> nearest_two(std::span<word_type const> query) const {
+    nearest_two_points best;
+    search(query, 0, order_.size(), best);
+    return {best.first, best.second};
+  }
+
+private:
+  /** @brief Build the subtree over tree positions `[lo, hi)`. */
+  void build_node(std::span<word_type const> points, std::size_t lo, std::size_t hi) {
+    if (hi - lo <= leaf_size) {
+      return;
+    }
+    std::span<word_type const> const vantage{points.data() + order_[lo] * wpi_, wpi_};
+    for (std::size_t pos = lo + 1; pos < hi; ++pos) {
+      scratch_[pos] = {hamming_distance(vantage, {points.data() + order_[pos] * wpi_, wpi_}),
+                       order_[pos]};
+    }
+    std::size_t const mid = lo + 1 + (hi - lo - 1) / 2;
+    auto const first = scratch_.begin() + static_cast<std::ptrdiff_t>(lo + 1);
+    std::nth_element(first, scratch_.begin() + static_cast<std::ptrdiff_t>(mid),
+                     scratch_.begin() + static_cast<std::ptrdiff_t>(hi));
+    for (std::size_t pos = lo + 1; pos < hi; ++pos) {
+      order_[pos] = scratch_[pos].second;
+    }
+    radius_[lo] = scratch_[mid].first;
+    split_[lo] = mid;
+    build_node(points, lo + 1, mid);
+    build_node(points, mid, hi);
+  }
+
+  /** @brief Nearest point found so far; points farther than it cannot improve the result. */
+  struct nearest_one {
+    neighbor first;
+
+    [[nodiscard]] std::size_t radius() const noexcept { return first.distance; }
+    void offer(neighbor const candidate) noexcept {
+      if (precedes(candidate, first)) {
+        first = candidate;
+      }
+    }
+  };
+
+  /** @brief Two nearest points found so far, the second bounding the search. */
+  struct nearest_two_points {
+    neighbor first;
+    neighbor second;
+
+    [[nodiscard]] std::size_t radius() const noexcept { return second.distance; }
+    void offer(neighbor const candidate) noexcept {
+      // Most points visited are farther than both; settle them with one test.
+      if (candidate.distance > second.distance) {
+        return;
+      }
+      if (precedes(candidate, first)) {
+        second = first;
+        first = candidate;
+      } else if (precedes(candidate, second)) {
+        second = candidate;
+      }
+    }
+  };
+
+  /** @brief Order neighbours by distance, then identifier. */
+  [[nodiscard]] static bool precedes(neighbor const a, neighbor const b) noexcept {
+    return a.distance < b.distance || (a.distance == b.distance && a.id < b.id);
+  }
+
+  /** @brief Search tree positions `[lo, hi)`, offering every point visited to `best`. */
+  template <typename Best>
+  void search(std::span<word_type const> query, std::size_t lo, std::size_t hi, Best &best) const {
+    if (hi - lo <= leaf_size) {
+      // A leaf's points are contiguous, so one kernel call measures them all.
+      std::array<std::size_t, leaf_size> distances;
+      hamming_distances(query, {points_.data() + lo * wpi_, (hi - lo) * wpi_},
+                        {distances.data(), hi - lo});
+      for (std::size_t pos = lo; pos < hi; ++pos) {
+        best.offer({order_[pos], distances[pos - lo]});
+      }
+      return;
+    }
+    std::size_t const d = visit(query, lo, best);
+    std::size_t const r = radius_[lo];
+    std::size_t const mid = split_[lo];
+    // A subtree holds a point within the search radius `b` only if
+    // d - b <= r (inside) or d + b >= r (outside), written here without
+    // overflow. Ties are kept (non-strict bounds) so the lowest identifier
+    // among equally near points is always reached.
+    auto const inside = [&] {
+      if (d <= r || d - r <= best.radius()) {
+        search(query, lo + 1, mid, best);
+      }
+    };
+    auto const outside = [&] {
+      if (r <= d || r - d <= best.radius()) {
+        search(query, mid, hi, best);
+      }
+    };
+    if (d < r) {
+      inside();
+      outside();
+    } else {
+      outside();
+      inside();
+    }
+  }
+
+  /** @brief Offer the point at tree position `pos` to `best`; return its distance. */
+  template <typename Best>
+  std::size_t visit(std::span<word_type const> query, std::size_t pos, Best &best) const {
+    std::size_t const d = hamming_distance(query, {points_.data() + pos * wpi_, wpi_});
+    best.offer({order_[pos], d});
+    return d;
+  }
+
+  std::size_t wpi_{};
+  /** Caller's identifier of the point at each tree position. */
+  std::vector<std::size_t> order_;
+  /** Median distance from the vantage point at an inner node's position. */
+  std::vector<std::size_t> radius_;
+  /** First position of an inner node's outside subtree. */
+  std::vector<std::size_t> split_;
+  /** Points in tree order. */
+  std::vector<word_type> points_;
+  /** (distance, identifier) pairs used while building. */
+  std::vector<std::pair<std::size_t, std::size_t>> scratch_;
+};
+
+} // namespace popc::detail
+
+#endif // POPC_DETAIL_VP_TREE_HPP
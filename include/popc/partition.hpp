@@ -0,0 +1,586 @@
+#ifndef POPC_PARTITION_HPP
+#define POPC_PARTITION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "cluster.hpp"
+#include "dataset.hpp"
+
+namespace popc {
+
+/**
+ * @brief Flat partition of a dataset into clusters with a shared count matrix.
+ *
+ * Holds the same information as a `std::list<popc::cluster>` — the
+ * members of every cluster and, per attribute, how many of them have it
+ * set — but stores all counts in one contiguous attribute-major matrix:
+ * row `j` lists attribute `j`'s count for every cluster, one column per
+ * cluster slot. A candidate scan over all clusters for one instance then
+ * streams one contiguous row per set attribute instead of chasing one
+ * heap block per cluster.
+ *
+ * Membership is intrusive: every instance carries its slot and the links
+ * of a doubly linked member list threaded through flat per-instance
+ * arrays, so move() relinks an instance in O(1) without allocating, while
+ * members are still visited in insertion order with a moved instance
+ * appended at the end.
+ *
+ * On request the partition also maintains an attribute index: for every
+ * attribute, the slots holding at least one member that has it set.
+ * Sparse data leaves most clusters out of most lists, which lets a
+ * candidate scan skip every cluster sharing no attribute with an
+ * instance.
+ *
+ * Slots are also kept ordered by size (by_size()), updated in O(1) per
+ * move, so a scan can visit the largest clusters first and stop once the
+ * remaining ones are too small to matter.
+ *
+ * Clusters occupy slots `[0, num_slots())` in a fixed order that plays
+ * the role of list order. erase() only marks a slot dead, so the slots of
+ * the other clusters stay put while a sweep is in flight; compact() later
+ * removes the dead columns in one pass, keeping the survivors in order.
+ * num_clusters() counts live slots, including empty clusters that have
+ * not been erased yet.
+ *
+ * Counts and member links are 32-bit, which halves the matrix against
+ * `std::size_t` and bounds the dataset at `2^32 - 1` instances.
+ */
+class partition {
+public:
+  using size_type = std::size_t;
+  using count_type = std::uint32_t;
+  /** @brief Instance or slot index in the intrusive member lists. */
+  using link_type = std::uint32_t;
+
+  /**
+   * @brief Forward iterator over the member instance indices of one slot.
+   *
+   * Stays valid while other instances move; moving the instance it points
+   * at re-links it, so advance past an instance before moving it.
+   */
+  class member_iterator {
+  public:
+    using iterator_concept = std::forward_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+    using value_type = size_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = size_type;
+
+    member_iterator() = default;
+
+    /** @brief Return the instance index at this position. */
+    [[nodiscard]] size_type operator*() const noexcept { return pos_; }
+
+    /** @brief Advance to the next member. */
+    member_iterator &operator++() noexcept {
+      pos_ = next_[pos_];
+      return *this;
+    }
+
+    /** @brief Advance to the next member, returning the old position. */
+    member_iterator operator++(int) noexcept {
+      auto const old = *this;
+      ++*this;
+      return old;
+    }
+
+    /** @brief Compare positions. */
+    friend bool operator==(member_iterator const &, member_iterator const &) = default;
+
+  private:
+    friend class partition;
+    member_iterator(link_type const *next, link_type pos) noexcept : next_{next}, pos_{pos} {}
+
+    link_type const *next_{};
+    link_type pos_{no_instance};
+  };
+
+  /** @brief The members of one slot, in insertion order. */
+  class member_range {
+  public:
+    /** @brief Return an iterator to the first member instance index. */
+    [[nodiscard]] member_iterator begin() const noexcept { return begin_; }
+
+    /** @brief Return an iterator past the last member instance index. */
+    [[nodiscard]] member_iterator end() const noexcept { return {begin_.next_, no_instance}; }
+
+    /** @brief Return the number of members. */
+    [[nodiscard]] size_type size() const noexcept { return size_; }
+
+    /** @brief Return `true` when there are no members. */
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  private:
+    friend class partition;
+    member_range(member_iterator begin, size_type size) noexcept : begin_{begin}, size_{size} {}
+
+    member_iterator begin_;
+    size_type size_;
+  };
+
+  /**
+   * @brief Read-only view of one cluster slot with the popc::cluster API.
+   *
+   * Lets code written against popc::cluster (for example popc::compute_delta())
+   * read a cluster of the partition in place. Invalidated by compact().
+   */
+  class cluster_view {
+  public:
+    using const_iterator = member_iterator;
+
+    /**
+     * @brief Construct a view of one slot.
+     *
+     * @param part Partition holding the slot; must outlive the view.
+     * @param slot Slot index in `[0, part.num_slots())`.
+     */
+    cluster_view(partition const &part, size_type slot) noexcept : part_{&part}, slot_{slot} {}
+
+    /** @brief Return the slot this view refers to. */
+    [[nodiscard]] size_type slot() const noexcept { return slot_; }
+
+    /** @brief Return `true` when the cluster has no member instances. */
+    [[nodiscard]] bool empty() const noexcept { return part_->empty(slot_); }
+
+    /** @brief Return the number of member instances. */
+    [[nodiscard]] size_type num_instances() const noexcept { return part_->sizes_[slot_]; }
+
+    /** @brief Return the number of members that have `attribute_num` set. */
+    [[nodiscard]] size_type attribute_count(size_type attribute_num) const noexcept {
+      return part_->count(slot_, attribute_num);
+    }
+
+    /** @brief Return an iterator to the first member instance index. */
+    [[nodiscard]] const_iterator begin() const noexcept { return part_->members(slot_).begin(); }
+
+    /** @brief Return an iterator past the last member instance index. */
+    [[nodiscard]] const_iterator end() const noexcept { return part_->members(slot_).end(); }
+
+    /** @brief Return an iterator to the first member instance index. */
+    [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+
+    /** @brief Return an iterator past the last member instance index. */
+    [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+  private:
+    partition const *part_;
+    size_type slot_;
+  };
+
+  /** @brief Construct an empty partition with no clusters. */
+  partition() = default;
+
+  /**
+   * @brief Build a partition from a label per instance.
+   *
+   * Slot `k` holds the instances labelled `k`, in increasing instance
+   * order, so the partition has `max(labels) + 1` slots; a label with no
+   * instances yields an empty cluster.
+   *
+   * @param ds     Dataset the labels refer to.
+   * @param labels One label per instance of `ds`.
+   *
+   * @throws std::logic_error if `labels.size() != ds.num_instances()`, or
+   *         if there are more than `2^32 - 1` instances or slots.
+   */
+  partition(popc::dataset const &ds, std::span<size_type const> labels)
+      : num_attributes_{ds.num_attributes()} {
+    if (labels.size() != ds.num_instances()) {
+      throw std::logic_error{"labels size must equal the number of instances"};
+    }
+    size_type num_slots = 0;
+    for (auto const label : labels) {
+      num_slots = std::max(num_slots, label + 1);
+    }
+    reset(ds, num_slots);
+    for (size_type i = 0; i < labels.size(); ++i) {
+      append(i, labels[i]);
+      for (auto const attribute_num : ds.positive_attributes(i)) {
+        ++counts_[attribute_num * num_slots_ + labels[i]];
+      }
+    }
+  }
+
+  /**
+   * @brief Build a partition from a list of clusters.
+   *
+   * Slot order follows list order and members keep their order; counts
+   * are copied as they are, so each cluster's counts must already match
+   * its members, and every instance must belong to exactly one cluster.
+   *
+   * @param ds       Dataset the clusters refer to.
+   * @param clusters Clusters to copy, each sized for `ds.num_attributes()`.
+   *
+   * @throws std::logic_error if there are more than `2^32 - 1` instances
+   *         or clusters.
+   */
+  partition(popc::dataset const &ds, std::list<popc::cluster> const &clusters)
+      : num_attributes_{ds.num_attributes()} {
+    reset(ds, clusters.size());
+    size_type slot = 0;
+    for (auto const &c : clusters) {
+      for (auto const instance_num : c) {
+        append(instance_num, slot);
+      }
+      for (size_type j = 0; j < num_attributes_; ++j) {
+        counts_[j * num_slots_ + slot] = static_cast<count_type>(c.attribute_count(j));
+      }
+      ++slot;
+    }
+  }
+
+  /** @brief Return the number of attributes each cluster counts. */
+  [[nodiscard]] size_type num_attributes() const noexcept { return num_attributes_; }
+
+  /** @brief Return the number of instances the partition covers. */
+  [[nodiscard]] size_type num_instances() const noexcept { return slot_of_.size(); }
+
+  /** @brief Return the number of live clusters, empty or not (the `N` of the objective). */
+  [[nodiscard]] size_type num_clusters() const noexcept { return num_clusters_; }
+
+  /** @brief Return the number of slots, live or erased; the count matrix row length. */
+  [[nodiscard]] size_type num_slots() const noexcept { return num_slots_; }
+
+  /** @brief Return `true` unless `slot` has been erased. */
+  [[nodiscard]] bool alive(size_type slot) const noexcept { return alive_[slot] != 0; }
+
+  /** @brief Return a read-only popc::cluster-style view of `slot`. */
+  [[nodiscard]] cluster_view cluster(size_type slot) const noexcept { return {*this, slot}; }
+
+  /** @brief Return `true` when the cluster in `slot` has no members. */
+  [[nodiscard]] bool empty(size_type slot) const noexcept { return sizes_[slot] == 0; }
+
+  /** @brief Return the slot currently holding `instance_num`. */
+  [[nodiscard]] size_type slot_of(size_type instance_num) const noexcept {
+    return slot_of_[instance_num];
+  }
+
+  /** @brief Return the count of members of `slot` that have `attribute_num` set. */
+  [[nodiscard]] count_type count(size_type slot, size_type attribute_num) const noexcept {
+    return counts_[attribute_num * num_slots_ + slot];
+  }
+
+  /**
+   * @brief Return attribute `attribute_num`'s count in every slot.
+   *
+   * @return Span of num_slots() counts, slot `k` at index `k`. Erased
+   *         slots read as zero.
+   */
+  [[nodiscard]] std::span<count_type const> attribute_row(size_type attribute_num) const noexcept {
+    return {counts_.data() + attribute_num * num_slots_, num_slots_};
+  }
+
+  /** @brief Return the number of members of `slot`. */
+  [[nodiscard]] size_type size(size_type slot) const noexcept { return sizes_[slot]; }
+
+  /**
+   * @brief Return every slot, ordered by nonincreasing size.
+   *
+   * Erased slots are included, with size zero. The order among slots of
+   * equal size is unspecified. Maintained by move(); invalidated, like
+   * slot indices, by compact().
+   */
+  [[nodiscard]] std::span<link_type const> by_size() const noexcept { return by_size_; }
+
+  /** @brief Return the members of `slot` in insertion order. */
+  [[nodiscard]] member_range members(size_type slot) const noexcept {
+    return {member_iterator{next_.data(), head_[slot]}, sizes_[slot]};
+  }
+
+  /**
+   * @brief Move one instance to the end of another cluster.
+   *
+   * Unlinks the instance from its current slot, appends it to `dest`, and
+   * updates the counts of every attribute it has set, along with the
+   * attribute index when one is maintained. O(set attributes); only an
+   * attribute index list that outgrows its capacity allocates.
+   *
+   * @param ds           Dataset providing the instance's set attributes.
+   * @param instance_num Instance to move.
+   * @param dest         Live destination slot, different from the
+   *                     instance's current slot.
+   */
+  void move(popc::dataset const &ds, size_type instance_num, size_type dest) {
+    size_type const src = slot_of_[instance_num];
+    unlink(instance_num);
+    append(instance_num, dest);
+    for (auto const attribute_num : ds.positive_attributes(instance_num)) {
+      if (--counts_[attribute_num * num_slots_ + src] == 0 && indexed_) {
+        index_erase(attribute_num, src);
+      }
+      if (counts_[attribute_num * num_slots_ + dest]++ == 0 && indexed_) {
+        index_insert(attribute_num, dest);
+      }
+    }
+  }
+
+  /**
+   * @brief Build the attribute index and keep it current from now on.
+   *
+   * The index lists, for every attribute, the slots whose count of that
+   * attribute is nonzero. move() and compact() maintain it once built.
+   * Costs one 32-bit position per count-matrix cell on top of the lists.
+   */
+  void build_attribute_index() {
+    index_.assign(num_attributes_, {});
+    index_pos_.assign(counts_.size(), 0);
+    for (size_type j = 0; j < num_attributes_; ++j) {
+      for (size_type k = 0; k < num_slots_; ++k) {
+        if (counts_[j * num_slots_ + k] != 0) {
+          index_insert(j, k);
+        }
+      }
+    }
+    indexed_ = true;
+  }
+
+  /** @brief Return `true` once build_attribute_index() has been called. */
+  [[nodiscard]] bool has_attribute_index() const noexcept { return indexed_; }
+
+  /**
+   * @brief Return the slots with a nonzero count of `attribute_num`.
+   *
+   * Requires has_attribute_index(). The order is unspecified; erased slots
+   * never appear, since they are empty.
+   */
+  [[nodiscard]] std::span<link_type const> clusters_with(size_type attribute_num) const noexcept {
+    return index_[attribute_num];
+  }
+
+  /**
+   * @brief Erase an empty cluster.
+   *
+   * The slot is only marked dead; other slots keep their indices until
+   * compact().
+   *
+   * @param slot Live, empty slot.
+   */
+  void erase(size_type slot) noexcept {
+    alive_[slot] = 0;
+    --num_clusters_;
+  }
+
+  /**
+   * @brief Drop erased slots, keeping the live ones in order.
+   *
+   * Rebuilds the count matrix with one column per live cluster. A no-op
+   * when nothing has been erased. Invalidates slot indices and views.
+   */
+  void compact() {
+    if (num_clusters_ == num_slots_) {
+      return;
+    }
+    std::vector<count_type> counts(num_attributes_ * num_clusters_);
+    for (size_type j = 0; j < num_attributes_; ++j) {
+      count_type const *const from = counts_.data() + j * num_slots_;
+      count_type *to = counts.data() + j * num_clusters_;
+      for (size_type k = 0; k < num_slots_; ++k) {
+        if (alive_[k] != 0) {
+          *to++ = from[k];
+        }
+      }
+    }
+    std::vector<link_type> new_slot(num_slots_);
+    size_type live = 0;
+    for (size_type k = 0; k < num_slots_; ++k) {
+      if (alive_[k] != 0) {
+        new_slot[k] = static_cast<link_type>(live);
+        head_[live] = head_[k];
+        tail_[live] = tail_[k];
+        sizes_[live] = sizes_[k];
+        ++live;
+      }
+    }
+    for (auto &slot : slot_of_) {
+      slot = new_slot[slot];
+    }
+    counts_ = std::move(counts);
+    num_slots_ = num_clusters_;
+    head_.resize(num_slots_);
+    tail_.resize(num_slots_);
+    sizes_.resize(num_slots_);
+    alive_.assign(num_slots_, 1);
+    sort_by_size();
+    if (indexed_) {
+      build_attribute_index();
+    }
+  }
+
+  /**
+   * @brief Return a label per instance.
+   *
+   * Live clusters are numbered `0, 1, ...` in slot order.
+   */
+  [[nodiscard]] std::vector<size_type> labels() const {
+    std::vector<size_type> rank(num_slots_);
+    size_type label = 0;
+    for (size_type k = 0; k < num_slots_; ++k) {
+      rank[k] = label;
+      if (alive_[k] != 0) {
+        ++label;
+      }
+    }
+    std::vector<size_type> out(slot_of_.size());
+    for (size_type i = 0; i < out.size(); ++i) {
+      out[i] = rank[slot_of_[i]];
+    }
+    return out;
+  }
+
+  /**
+   * @brief Copy the live clusters out as a list, in slot order.
+   */
+  [[nodiscard]] std::list<popc::cluster> to_clusters() const {
+    std::list<popc::cluster> out;
+    for (size_type k = 0; k < num_slots_; ++k) {
+      if (alive_[k] == 0) {
+        continue;
+      }
+      auto &c = out.emplace_back(num_attributes_);
+      for (auto const instance_num : members(k)) {
+        c.add_instance(instance_num);
+      }
+      for (size_type j = 0; j < num_attributes_; ++j) {
+        for (count_type n = count(k, j); n != 0; --n) {
+          c.increment_attribute_count(j);
+        }
+      }
+    }
+    return out;
+  }
+
+private:
+  /** @brief Link sentinel: no previous, next, first or last member. */
+  static constexpr link_type no_instance = std::numeric_limits<count_type>::max();
+
+  /** @brief Size every array for `ds` and `num_slots` empty clusters. */
+  void reset(popc::dataset const &ds, size_type num_slots) {
+    if (ds.num_instances() > std::numeric_limits<link_type>::max() ||
+        num_slots > std::numeric_limits<link_type>::max()) {
+      throw std::logic_error{"partition supports at most 2^32 - 1 instances and clusters"};
+    }
+    num_slots_ = num_slots;
+    num_clusters_ = num_slots;
+    counts_.assign(num_attributes_ * num_slots, 0);
+    head_.assign(num_slots, no_instance);
+    tail_.assign(num_slots, no_instance);
+    sizes_.assign(num_slots, 0);
+    alive_.assign(num_slots, 1);
+    next_.assign(ds.num_instances(), no_instance);
+    prev_.assign(ds.num_instances(), no_instance);
+    slot_of_.assign(ds.num_instances(), 0);
+    larger_.assign(ds.num_instances() + 1, 0);
+    sort_by_size();
+  }
+
+  /** @brief Rebuild by_size() and the bucket bounds from the sizes. */
+  void sort_by_size() {
+    std::fill(larger_.begin(), larger_.end(), 0);
+    for (size_type k = 0; k < num_slots_; ++k) {
+      for (count_type s = 0; s < sizes_[k]; ++s) {
+        ++larger_[s];
+      }
+    }
+    std::vector<link_type> next_pos = larger_;
+    by_size_.resize(num_slots_);
+    size_pos_.resize(num_slots_);
+    for (size_type k = 0; k < num_slots_; ++k) {
+      link_type const pos = next_pos[sizes_[k]]++;
+      by_size_[pos] = static_cast<link_type>(k);
+      size_pos_[k] = pos;
+    }
+  }
+
+  /** @brief Exchange the by_size() positions of two slots. */
+  void swap_by_size(link_type pos, link_type other) noexcept {
+    link_type const a = by_size_[pos];
+    link_type const b = by_size_[other];
+    by_size_[pos] = b;
+    by_size_[other] = a;
+    size_pos_[a] = other;
+    size_pos_[b] = pos;
+  }
+
+  /** @brief Link `instance_num` at the end of `slot`'s members. */
+  void append(size_type instance_num, size_type slot) noexcept {
+    auto const i = static_cast<link_type>(instance_num);
+    prev_[i] = tail_[slot];
+    next_[i] = no_instance;
+    if (tail_[slot] == no_instance) {
+      head_[slot] = i;
+    } else {
+      next_[tail_[slot]] = i;
+    }
+    tail_[slot] = i;
+    // The slot moves from the front of its size bucket to the end of the
+    // next larger one.
+    count_type const old_size = sizes_[slot]++;
+    swap_by_size(size_pos_[slot], larger_[old_size]);
+    ++larger_[old_size];
+    slot_of_[i] = static_cast<link_type>(slot);
+  }
+
+  /** @brief Add `slot` to the index list of `attribute_num`. */
+  void index_insert(size_type attribute_num, size_type slot) {
+    auto &list = index_[attribute_num];
+    index_pos_[attribute_num * num_slots_ + slot] = static_cast<link_type>(list.size());
+    list.push_back(static_cast<link_type>(slot));
+  }
+
+  /** @brief Remove `slot` from the index list of `attribute_num` by swapping in the last entry. */
+  void index_erase(size_type attribute_num, size_type slot) noexcept {
+    auto &list = index_[attribute_num];
+    link_type const pos = index_pos_[attribute_num * num_slots_ + slot];
+    link_type const last = list.back();
+    list[pos] = last;
+    index_pos_[attribute_num * num_slots_ + last] = pos;
+    list.pop_back();
+  }
+
+  /** @brief Unlink `instance_num` from its slot's members. */
+  void unlink(size_type instance_num) noexcept {
+    size_type const slot = slot_of_[instance_num];
+    link_type const prev = prev_[instance_num];
+    link_type const next = next_[instance_num];
+    (prev == no_instance ? head_[slot] : next_[prev]) = next;
+    (next == no_instance ? tail_[slot] : prev_[next]) = prev;
+    // The slot moves from the end of its size bucket to the front of the
+    // next smaller one.
+    count_type const new_size = --sizes_[slot];
+    --larger_[new_size];
+    swap_by_size(size_pos_[slot], larger_[new_size]);
+  }
+
+  size_type num_attributes_{};
+  size_type num_slots_{};
+  size_type num_clusters_{};
+  std::vector<count_type> counts_;
+  std::vector<link_type> head_;
+  std::vector<link_type> tail_;
+  std::vector<count_type> sizes_;
+  std::vector<char> alive_;
+  std::vector<link_type> next_;
+  std::vector<link_type> prev_;
+  std::vector<link_type> slot_of_;
+  // Slots by nonincreasing size, each slot's position there, and, for
+  // every size s, the number of slots larger than s: the first position
+  // of size-s slots.
+  std::vector<link_type> by_size_;
+  std::vector<link_type> size_pos_;
+  std::vector<link_type> larger_;
+  bool indexed_{};
+  std::vector<std::vector<link_type>> index_;
+  std::vector<link_type> index_pos_;
+};
+
+} // namespace popc
+
+#endif // POPC_PARTITION_HPP
@@ -1,17 +1,194 @@
 #ifndef POPC_POPC_HPP
 #define POPC_POPC_HPP
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <functional>
 #include <limits>
 #include <list>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <vector>
 
 #include "cluster.hpp"
 #include "dataset.hpp"
+#include "detail/delta_kernel.hpp"
+#include "detail/integer_power.hpp"
+#include "detail/power_table.hpp"
+#include "detail/thread_pool.hpp"
+#include "partition.hpp"
 
 namespace popc {
 
+/**
+ * @brief Evaluation strategy for the `p^P` terms of popc::compute_delta().
+ *
+ * The exact engines produce bit-identical deltas and therefore identical
+ * assignments; they differ only in cost. The approximate engine trades a
+ * bounded error in every term for cheaper table refills, then makes the
+ * result exact.
+ */
+enum class delta_engine : char {
+  /** Raise every term of every delta as it is needed. */
+  pow = 0,
+  /** Look terms up in a per-attribute popc::detail::power_table. */
+  table = 1,
+  /**
+   * Like `table`, but fill rows with popc::detail::approx_pow(), which is
+   * within a relative `(2 |P log2 p| + 4P + 8)` units in the last place of
+   * `p^P`. Once no approximate move remains, popc::popc() switches to the
+   * exact terms of `table` and sweeps on until no exact move remains
+   * either, so the result is still a local optimum of the exact objective.
+   * Requires `Cm >= 0` and `P >= 0`.
+   */
+  approx = 2,
+};
+
+/**
+ * @brief Order in which popc::popc() evaluates and applies moves.
+ */
+enum class sweep_mode : char {
+  /**
+   * Gauss-Seidel order of the reference algorithm: every instance is
+   * evaluated against counts that already include all earlier moves.
+   */
+  sequential = 0,
+  /**
+   * Jacobi-style batches: the best move of every instance in a batch is
+   * chosen concurrently against frozen counts, then the moves are
+   * re-validated against the live counts and applied in order.
+   */
+  batched = 1,
+};
+
+/**
+ * @brief Candidate-scan counters of one popc::popc() run.
+ *
+ * Every instance visited has `N - 1` candidate destinations; these count
+ * how many of them had their delta computed and how many the pruning
+ * strategies ruled out, summed over the run.
+ */
+struct scan_stats {
+  /** Candidate destinations, summed over every instance scanned. */
+  std::size_t candidates = 0;
+  /**
+   * Candidates whose delta was computed. The clusters sharing no
+   * attribute with an instance all have the same delta and count once.
+   */
+  std::size_t evaluated = 0;
+  /**
+   * Candidates skipped because their gain bound could not beat the best
+   * move (options::bound_pruning).
+   */
+  std::size_t bound_skipped = 0;
+  /**
+   * Candidates skipped because they did not change since the instance's
+   * last scan found no move, and still cannot offer a positive gain
+   * (options::dirty_tracking).
+   */
+  std::size_t unchanged_skipped = 0;
+};
+
+/**
+ * @brief Progress of one popc::popc() sweep, passed to options::observer.
+ *
+ * @tparam fptype Floating-point type for the probability arithmetic.
+ */
+template <typename fptype = double> struct sweep_report {
+  /** One-based index of the sweep within the run. */
+  std::size_t sweep = 0;
+  /** Live clusters `N` at the end of the sweep. */
+  std::size_t num_clusters = 0;
+  /** Instances moved during the sweep. */
+  std::size_t moves = 0;
+  /**
+   * Objective `J` of the partition at the end of the sweep: `p^P` summed
+   * over every cluster and attribute, with the sweep's terms.
+   */
+  fptype objective = 0;
+  /** Whether the sweep scored moves with delta_engine::approx terms. */
+  bool approximate = false;
+  /** The sweep's share of the run's scan_stats. */
+  scan_stats scan;
+  /** Wall time of the sweep, excluding the objective and the observer. */
+  std::chrono::nanoseconds elapsed{};
+};
+
+/**
+ * @brief Tuning knobs for popc::popc().
+ *
+ * @tparam fptype Floating-point type for the probability arithmetic.
+ */
+template <typename fptype = double> struct options {
+  /** The `Cm` hyperparameter (paper default 1000). */
+  fptype multiplier = static_cast<fptype>(1000);
+  /** The `P` hyperparameter (paper default 10). */
+  fptype power = static_cast<fptype>(10);
+  /** How the `p^P` terms are evaluated. */
+  delta_engine engine = delta_engine::table;
+  /**
+   * Evaluate `p^P` by repeated squaring instead of `std::pow`, with table
+   * rows filled by kernels unrolled for the power; `power` must then be an
+   * integer in `[0, popc::detail::max_integer_power]`. Much cheaper per
+   * term, but rounds differently, so assignments can differ from the
+   * `std::pow` ones where two moves tie to within a few units in the last
+   * place. Both engines still agree with each other.
+   */
+  bool integer_power = false;
+  /**
+   * Threads sharing the candidate-cluster scan of each instance; 1 (the
+   * default) scans serially and 0 is treated as 1. The result does not
+   * depend on this value.
+   */
+  std::size_t num_threads = 1;
+  /** Move evaluation order; see sweep_mode. */
+  sweep_mode sweep = sweep_mode::sequential;
+  /**
+   * Instances per batch in sweep_mode::batched (0 is treated as 1).
+   * Larger batches expose more parallelism but evaluate more instances
+   * against stale counts. The result depends on this value but not on
+   * `num_threads`.
+   */
+  std::size_t batch_size = 4096;
+  /**
+   * Maintain an attribute-to-cluster index (popc::partition::build_attribute_index())
+   * and, for instances whose attributes few clusters hold, score only
+   * those clusters explicitly: every other candidate has the same delta,
+   * which is computed once. Exact; costs one 32-bit position per
+   * count-matrix cell. The result does not depend on this value.
+   */
+  bool attribute_index = true;
+  /**
+   * Branch and bound: visit candidate clusters from largest to smallest
+   * and stop once an upper bound on the gain of every remaining cluster,
+   * which depends only on its size, can no longer beat the best move found
+   * or reach a positive gain. Exact, including ties; applies to serial
+   * scans with `power >= 1`. The result does not depend on this value.
+   */
+  bool bound_pruning = true;
+  /**
+   * In sequential sweeps, remember which clusters changed since each
+   * instance was last scanned. An instance that found no move last time
+   * is rescored only against the clusters that changed since, or skipped
+   * when none did, as long as a bound on the other clusters' deltas,
+   * adjusted for changes to its own cluster and to `N`, stays non-positive.
+   * Exact; costs a few words per instance. The result does not depend on
+   * this value.
+   */
+  bool dirty_tracking = true;
+  /** When non-null, receives the run's scan_stats. */
+  scan_stats *stats = nullptr;
+  /**
+   * When set, called after every sweep with its sweep_report. Computing
+   * the objective costs one term per cluster and attribute, which is only
+   * paid when an observer is set.
+   */
+  std::function<void(sweep_report<fptype> const &)> observer{};
+};
+
 /**
  * @brief Compute the change in the POPC objective J for a single move.
  *
@@ -19,7 +196,8 @@ namespace popc {
  * the attributes that are positive in instance `instance_num`. Attributes
  * that are zero in the instance leave the cluster's per-attribute count
  * unchanged for the candidate move and contribute zero to the delta, so
- * they are skipped.
+ * they are never visited: the loop walks the dataset's sparse
+ * dataset::positive_attributes() index and costs O(set bits), not O(F).
  *
  * The per-attribute probability is
  * `p(cluster|f_i) = (counts * Cm + 1) / (counts_all * Cm + N)`, where:
@@ -38,8 +216,10 @@ namespace popc {
  *                      `double` is the default and the recommended choice;
  *                      `float` produces visibly different rankings for
  *                      borderline moves on large datasets.
- * @param ds            Dataset providing `positive_count` and the row
- *                      iterators for `instance_num`.
+ * @tparam cluster_type popc::cluster or popc::partition::cluster_view; any
+ *                      type with `attribute_count(std::size_t)`.
+ * @param ds            Dataset providing `positive_count` and the set
+ *                      attribute index for `instance_num`.
  * @param cluster       Source or destination cluster whose `attribute_count`
  *                      is read for the current `counts` term.
  * @param instance_num  Zero-based index of the instance being moved.
@@ -54,24 +234,70 @@ namespace popc {
  *
  * @return Change in the cluster's contribution to J for the move.
  */
-template <typename fptype = double>
-[[nodiscard]] fptype compute_delta(popc::dataset const &ds, popc::cluster const &cluster,
+template <typename fptype = double, typename cluster_type>
+[[nodiscard]] fptype compute_delta(popc::dataset const &ds, cluster_type const &cluster,
                                    std::size_t instance_num, std::size_t num_clusters,
                                    fptype multiplier, fptype power, bool added) {
+  return compute_delta(ds, cluster, instance_num, num_clusters, multiplier,
+                       detail::power_function<fptype>{power}, added);
+}
+
+/**
+ * @brief compute_delta() with a chosen `p^P` evaluation.
+ *
+ * Identical to the overload taking `power`, but raises each probability
+ * with `raise`, so repeated squaring can stand in for `std::pow`.
+ */
+template <typename fptype, typename cluster_type>
+[[nodiscard]] fptype compute_delta(popc::dataset const &ds, cluster_type const &cluster,
+                                   std::size_t instance_num, std::size_t num_clusters,
+                                   fptype multiplier, detail::power_function<fptype> const &raise,
+                                   bool added) {
   fptype delta = 0;
-  std::size_t attribute_num = 0;
-  for (auto it = ds.cbegin(instance_num); it != ds.cend(instance_num); ++it) {
-    if (*it) {
-      auto const counts = static_cast<fptype>(cluster.attribute_count(attribute_num));
-      auto const counts_all = static_cast<fptype>(ds.positive_count(attribute_num));
-      fptype const denom = counts_all * multiplier + static_cast<fptype>(num_clusters);
-      fptype const old_p = (counts * multiplier + 1) / denom;
-      fptype const new_count = added ? counts + 1 : counts - 1;
-      fptype const new_p = (new_count * multiplier + 1) / denom;
-      delta -= std::pow(old_p, power);
-      delta += std::pow(new_p, power);
-    }
-    ++attribute_num;
+  for (auto const attribute_num : ds.positive_attributes(instance_num)) {
+    auto const counts = static_cast<fptype>(cluster.attribute_count(attribute_num));
+    auto const counts_all = static_cast<fptype>(ds.positive_count(attribute_num));
+    fptype const denom = counts_all * multiplier + static_cast<fptype>(num_clusters);
+    fptype const old_p = (counts * multiplier + 1) / denom;
+    fptype const new_count = added ? counts + 1 : counts - 1;
+    fptype const new_p = (new_count * multiplier + 1) / denom;
+    delta -= raise(old_p);
+    delta += raise(new_p);
+  }
+  return delta;
+}
+
+/**
+ * @brief Table-driven variant of compute_delta().
+ *
+ * Reads `p^P` terms from `table` instead of raising them. The table
+ * must have been built for `ds` and have its cluster count set to the
+ * current partition size; the result is then bit-identical to the
+ * direct overload with the table's multiplier and power_function.
+ *
+ * @tparam fptype       Floating-point type for the probability arithmetic.
+ * @tparam cluster_type popc::cluster or popc::partition::cluster_view.
+ * @param ds            Dataset providing the set attribute index for
+ *                      `instance_num`.
+ * @param cluster       Source or destination cluster whose `attribute_count`
+ *                      is read for the current `counts` term.
+ * @param instance_num  Zero-based index of the instance being moved.
+ * @param table         Power table for `ds` at the current cluster count.
+ * @param added         `true` if `cluster` is the destination, `false` if
+ *                      it is the source.
+ *
+ * @return Change in the cluster's contribution to J for the move.
+ */
+template <typename fptype, typename cluster_type>
+[[nodiscard]] fptype compute_delta(popc::dataset const &ds, cluster_type const &cluster,
+                                   std::size_t instance_num, detail::power_table<fptype> &table,
+                                   bool added) {
+  fptype delta = 0;
+  for (auto const attribute_num : ds.positive_attributes(instance_num)) {
+    auto const row = table.row(attribute_num);
+    auto const counts = cluster.attribute_count(attribute_num);
+    delta -= row[counts];
+    delta += row[added ? counts + 1 : counts - 1];
   }
   return delta;
 }
@@ -87,88 +313,753 @@ template <typename fptype = double>
  * always reflects the current partition size. The loop terminates when
  * an entire pass over every instance produces no moves.
  *
- * The seeded `clusters` argument is consumed in place: the function
- * mutates it as moves are accepted, and the resulting partition lives
- * in this list at return time. The returned label vector is a flat
- * `instance_num -> cluster_index` map produced by walking the final
- * cluster list.
+ * Clusters are visited in slot order and the members of each in order;
+ * the seeded `part` is mutated in place and holds the resulting partition
+ * at return time, compacted so that every slot is live. The returned label
+ * vector is a flat `instance_num -> cluster_index` map with clusters
+ * numbered in slot order.
+ *
+ * The candidate scan for one instance walks the count-matrix row of each
+ * attribute the instance has set and accumulates the destination delta
+ * of every candidate cluster at once, so it streams contiguous memory.
+ * With the table engine each row goes through the widest SIMD kernel the
+ * CPU supports (popc::detail::accumulate_terms()), gathering the table
+ * terms of 4 to 16 candidates per instruction. Each candidate's terms are
+ * still added in attribute order, so its delta is bit-identical to
+ * compute_delta() on that cluster.
+ *
+ * With `opts.bound_pruning`, a serial scan instead visits candidates from
+ * the largest cluster to the smallest, scoring them a chunk at a time,
+ * and stops once a bound on the gain of any cluster of the current size,
+ * which never exceeds that of a larger one, rules out the rest. The bound
+ * carries a margin for rounding, so no cluster that the full scan would
+ * choose, ties included, is ever skipped.
+ *
+ * With `opts.dirty_tracking`, sequential sweeps remember, for every
+ * instance whose scan found no move, the best gain it saw. A later scan
+ * scores only the clusters that have changed since, or none, when a bound
+ * derived from that gain shows that no other cluster can have become a
+ * positive move; late sweeps, when few clusters still change, then cost a
+ * fraction of the first.
+ *
+ * With `opts.num_threads > 1`, the scan over candidate destinations for
+ * one instance is split into contiguous ranges of slots that are
+ * evaluated concurrently; each range keeps its first best candidate and
+ * the ranges are reduced in slot order with the same strict comparison.
+ * Every delta is computed with the same operands and in the same order as
+ * the serial scan, so the chosen move, and therefore the final partition,
+ * is identical to a single-threaded run. Scans with too few candidates to
+ * amortize the hand-off stay serial.
+ *
+ * With `opts.sweep == sweep_mode::batched`, a sweep visits the instances
+ * in the same order but in batches of `opts.batch_size`. Every instance
+ * of a batch picks its best destination against the counts as they were
+ * when the batch started, one instance per thread. The proposals are then
+ * applied in order, each only if its exact gain against the live counts,
+ * which earlier moves in the batch may have changed, is still strictly
+ * positive. Every applied move therefore increases the objective, just
+ * as in the sequential sweep, and the loop stops at the same kind of
+ * local optimum. The trajectory, and so the final partition, generally
+ * differs from the sequential one. Empty clusters are erased at the end
+ * of each batch.
+ *
+ * With `opts.engine == delta_engine::approx`, sweeps first score moves
+ * with approximate terms. When a sweep finds no move, the terms become
+ * exact and sweeps continue, in the same mode, until one finds no move;
+ * the returned partition is therefore a local optimum under the exact
+ * compute_delta(), though generally not the one the exact engines reach.
+ *
+ * With `opts.observer` set, every sweep ends with a sweep_report of the
+ * partition it left, including the last sweep, which moves nothing. The
+ * observer runs on the calling thread and must not modify `part`.
  *
  * @tparam fptype     Floating-point type for the probability arithmetic.
  *                    See compute_delta() for selection guidance.
  * @param ds          Source dataset; provides instance values and the
  *                    dataset-wide positive counts.
- * @param clusters    Seeded partition. Each cluster's `attribute_counts`
- *                    must already match its members. Mutated in place.
- * @param multiplier  The `Cm` hyperparameter (defaults to the paper's 1000).
- * @param power       The `P` hyperparameter (defaults to the paper's 10).
+ * @param part        Seeded partition of `ds`. Mutated in place.
+ * @param opts        Hyperparameters, evaluation strategy and thread
+ *                    count.
  *
  * @return Vector of size `ds.num_instances()` mapping each instance index
- *         to its final cluster index in `[0, clusters.size())`. Cluster
- *         indices are assigned in the order in which the clusters appear
- *         in `clusters` at return time.
+ *         to its final cluster index in `[0, part.num_clusters())`.
+ *
+ * @throws std::logic_error if `opts.integer_power` is set and `opts.power`
+ *         is not a small enough non-negative integer, or if the
+ *         approximate engine is chosen with a negative `opts.multiplier`
+ *         or `opts.power`.
  */
-template <typename fptype = double>
-[[nodiscard]] std::vector<std::size_t>
-popc(popc::dataset const &ds, std::list<popc::cluster> &clusters,
-     fptype multiplier = static_cast<fptype>(1000), fptype power = static_cast<fptype>(10)) {
+template <typename fptype>
+[[nodiscard]] std::vector<std::size_t> popc(popc::dataset const &ds, popc::partition &part,
+                                            options<fptype> const &opts) {
+  detail::power_function<fptype> const exact{opts.power, opts.integer_power};
+  bool approximate = opts.engine == delta_engine::approx;
+  if (approximate && !(opts.multiplier >= 0)) {
+    throw std::logic_error{"approximate engine requires a non-negative multiplier"};
+  }
+  auto raise = approximate
+                   ? detail::power_function<fptype>{detail::approximate_power, opts.power}
+                   : exact;
+  std::optional<detail::power_table<fptype>> table;
+  if (opts.engine != delta_engine::pow) {
+    table.emplace(ds, opts.multiplier, raise);
+  }
+  auto const delta_of = [&](std::size_t slot, std::size_t instance_num, bool added) {
+    if (table) {
+      return compute_delta(ds, part.cluster(slot), instance_num, *table, added);
+    }
+    return compute_delta(ds, part.cluster(slot), instance_num, part.num_clusters(),
+                         opts.multiplier, raise, added);
+  };
+
+  // Candidate scans shorter than this many clusters per thread are run
+  // serially; below it the fork-join hand-off costs more than it saves.
+  constexpr std::size_t min_candidates_per_task = 512;
+  std::optional<detail::thread_pool> pool;
+  if (opts.num_threads > 1) {
+    pool.emplace(opts.num_threads);
+  }
+
+  constexpr std::size_t no_slot = std::numeric_limits<std::size_t>::max();
+  struct best_move {
+    fptype gain = -std::numeric_limits<fptype>::infinity();
+    std::size_t dest = no_slot;
+  };
+  // Per-thread scan state, so concurrent scans never share any.
+  struct scan_scratch {
+    // Destination deltas of the clusters being scanned.
+    std::vector<fptype> acc;
+    // Sparse scan: the slots sharing an attribute with the instance, a
+    // flag per slot marking them, and their counts of one attribute.
+    std::vector<std::size_t> overlap;
+    std::vector<char> marked;
+    std::vector<partition::count_type> counts;
+    // Bounded scan: the most members of each of the instance's attributes
+    // any destination can hold.
+    std::vector<partition::count_type> caps;
+    // Bounded scan: the bound it stopped at, if it stopped early.
+    fptype ceiling{};
+    scan_stats stats;
+  };
+  std::vector<scan_scratch> scratch(pool ? pool->size() : 1);
+  // Add one attribute's destination terms to `acc[k]` for a cluster
+  // holding `counts[k]` members with it. No count may equal the
+  // attribute's total: the table has no entry past it.
+  auto const add_terms = [&](std::span<fptype> acc,
+                             std::span<partition::count_type const> counts,
+                             std::size_t attribute_num) {
+    if (table) {
+      detail::accumulate_terms(acc, counts, table->row(attribute_num));
+      return;
+    }
+    auto const counts_all = static_cast<fptype>(ds.positive_count(attribute_num));
+    fptype const denom = counts_all * opts.multiplier + static_cast<fptype>(part.num_clusters());
+    for (std::size_t k = 0; k < acc.size(); ++k) {
+      auto const count = static_cast<fptype>(counts[k]);
+      fptype const old_p = (count * opts.multiplier + 1) / denom;
+      fptype const new_p = ((count + 1) * opts.multiplier + 1) / denom;
+      acc[k] -= raise(old_p);
+      acc[k] += raise(new_p);
+    }
+  };
+  // Best destination among slots [first, last) other than `src`; strict
+  // `>` keeps the earliest of equal gains. The source slot is never
+  // evaluated, since its count may equal the attribute's total.
+  auto const scan = [&](std::size_t src, std::size_t instance_num, fptype delta_base,
+                        std::size_t first, std::size_t last, scan_scratch &state) {
+    auto &acc = state.acc;
+    acc.assign(last - first, 0);
+    std::span<fptype> const terms{acc};
+    std::size_t const split = std::clamp(src, first, last);
+    std::size_t const resume = std::clamp(src + 1, first, last);
+    for (auto const attribute_num : ds.positive_attributes(instance_num)) {
+      auto const counts = part.attribute_row(attribute_num);
+      add_terms(terms.first(split - first), counts.subspan(first, split - first), attribute_num);
+      add_terms(terms.subspan(resume - first), counts.subspan(resume, last - resume),
+                attribute_num);
+    }
+    best_move best;
+    for (std::size_t k = first; k < last; ++k) {
+      if (k == src || !part.alive(k)) {
+        continue;
+      }
+      ++state.stats.evaluated;
+      auto const delta = delta_base + acc[k - first];
+      if (delta > best.gain) {
+        best = {delta, k};
+      }
+    }
+    return best;
+  };
+  // Score `slots` into `acc`, gathering each attribute's counts first.
+  auto const gather_terms = [&](std::size_t instance_num, std::span<std::size_t const> slots,
+                                std::size_t lanes, scan_scratch &state) {
+    auto &counts = state.counts;
+    state.acc.assign(lanes, 0);
+    counts.assign(lanes, 0);
+    for (auto const attribute_num : ds.positive_attributes(instance_num)) {
+      auto const row = part.attribute_row(attribute_num);
+      for (std::size_t m = 0; m < slots.size(); ++m) {
+        counts[m] = row[slots[m]];
+      }
+      add_terms(state.acc, counts, attribute_num);
+    }
+  };
+
+  if (opts.attribute_index && !part.has_attribute_index()) {
+    part.build_attribute_index();
+  }
+  // The sparse scan pays for every index entry of the instance's
+  // attributes plus a gathered count per attribute and overlapping
+  // cluster; the dense scan streams one term per attribute and slot. Take
+  // the sparse one when the entries number under 1/sparse_ratio of the
+  // slots.
+  constexpr std::size_t sparse_ratio = 4;
+  auto const prefer_sparse = [&](std::size_t instance_num) {
+    if (!part.has_attribute_index()) {
+      return false;
+    }
+    std::size_t entries = 0;
+    for (auto const attribute_num : ds.positive_attributes(instance_num)) {
+      entries += part.clusters_with(attribute_num).size();
+    }
+    return entries * sparse_ratio < part.num_slots();
+  };
+  // Same result as scan() over every slot, scoring only the clusters that
+  // share an attribute with the instance. Every other live cluster has a
+  // zero count on each of the instance's attributes, so all of their
+  // deltas are identical: one extra zero-count lane scores the class, and
+  // its lowest slot stands for it. Ties go to the lower slot, as in the
+  // in-order dense scan.
+  auto const scan_sparse = [&](std::size_t src, std::size_t instance_num, fptype delta_base,
+                               scan_scratch &state) {
+    auto &overlap = state.overlap;
+    auto &marked = state.marked;
+    auto &acc = state.acc;
+    marked.resize(std::max(marked.size(), part.num_slots()));
+    overlap.clear();
+    marked[src] = 1;
+    auto const attributes = ds.positive_attributes(instance_num);
+    for (auto const attribute_num : attributes) {
+      for (auto const k : part.clusters_with(attribute_num)) {
+        if (marked[k] == 0) {
+          marked[k] = 1;
+          overlap.push_back(k);
+        }
+      }
+    }
+    std::size_t zero = 0;
+    while (zero < part.num_slots() && (marked[zero] != 0 || !part.alive(zero))) {
+      ++zero;
+    }
+    gather_terms(instance_num, overlap, overlap.size() + 1, state);
+    best_move best;
+    auto const consider = [&](fptype delta, std::size_t k) {
+      if (delta > best.gain || (delta == best.gain && k < best.dest)) {
+        best = {delta, k};
+      }
+    };
+    for (std::size_t m = 0; m < overlap.size(); ++m) {
+      consider(delta_base + acc[m], overlap[m]);
+      marked[overlap[m]] = 0;
+    }
+    state.stats.evaluated += overlap.size();
+    if (zero < part.num_slots()) {
+      consider(delta_base + acc[overlap.size()], zero);
+      ++state.stats.evaluated;
+    }
+    marked[src] = 0;
+    return best;
+  };
+
+  // Fold the deltas gather_terms() left in `state.acc` for `slots` into
+  // `best`; ties go to the lower slot, as in the in-order dense scan.
+  auto const pick = [](std::span<std::size_t const> slots, fptype delta_base,
+                       scan_scratch const &state, best_move &best) {
+    for (std::size_t m = 0; m < slots.size(); ++m) {
+      auto const delta = delta_base + state.acc[m];
+      if (delta > best.gain || (delta == best.gain && slots[m] < best.dest)) {
+        best = {delta, slots[m]};
+      }
+    }
+  };
+
+  // Branch and bound. Adding the instance to a cluster raises its term for
+  // each set attribute j from f_j(c) to f_j(c + 1), where f_j(c) =
+  // ((c * Cm + 1) / denom_j)^P is convex for P >= 1, so the step never
+  // shrinks as c grows. A destination of s members holds at most
+  // min(s, cap_j) instances with attribute j, cap_j being the dataset
+  // count less the source's, so the steps at those counts bound its gain;
+  // the bound grows with s. Slots are visited by nonincreasing size, and
+  // once the bound of the current size falls below the best gain found,
+  // or cannot reach a positive gain, no remaining slot can be chosen.
+  bool const bounded = opts.bound_pruning && opts.power >= 1 && opts.multiplier >= 0;
+  // Candidates scored per gather before the bound is checked again.
+  constexpr std::size_t bound_chunk = 32;
+  auto const term = [&](std::size_t attribute_num, std::size_t count) {
+    if (table) {
+      return table->row(attribute_num)[count];
+    }
+    auto const counts_all = static_cast<fptype>(ds.positive_count(attribute_num));
+    fptype const denom = counts_all * opts.multiplier + static_cast<fptype>(part.num_clusters());
+    return raise((static_cast<fptype>(count) * opts.multiplier + 1) / denom);
+  };
+  // Same result as scan() over every slot whenever that has a positive
+  // gain; otherwise only a non-positive one, or none.
+  auto const scan_bounded = [&](std::size_t src, std::size_t instance_num, fptype delta_base,
+                                scan_scratch &state) {
+    auto const attributes = ds.positive_attributes(instance_num);
+    auto &caps = state.caps;
+    caps.resize(attributes.size());
+    // Every computed delta and bound is a sum of 2|A| + 1 terms no larger
+    // than these, so their rounding errors, scaled by the few units each
+    // term may be off by itself, stay below `slack`.
+    fptype magnitude = std::abs(delta_base);
+    for (std::size_t m = 0; m < attributes.size(); ++m) {
+      auto const attribute_num = attributes[m];
+      caps[m] = static_cast<partition::count_type>(ds.positive_count(attribute_num) -
+                                                   part.count(src, attribute_num));
+      magnitude += term(attribute_num, caps[m]) + term(attribute_num, caps[m] + 1);
+    }
+    fptype const slack = static_cast<fptype>(4 * attributes.size() + 4) * raise.error_ulps() *
+                         std::numeric_limits<fptype>::epsilon() * magnitude;
+    best_move best;
+    state.ceiling = best.gain;
+    auto const hopeless = [&](std::size_t size) {
+      fptype bound = delta_base + slack;
+      for (std::size_t m = 0; m < attributes.size(); ++m) {
+        std::size_t const count = std::min<std::size_t>(size, caps[m]);
+        bound += term(attributes[m], count + 1) - term(attributes[m], count);
+      }
+      if (!(bound > 0) || bound < best.gain) {
+        state.ceiling = bound;
+        return true;
+      }
+      return false;
+    };
+    auto const order = part.by_size();
+    auto &slots = state.overlap;
+    std::size_t evaluated = 0;
+    std::size_t pos = 0;
+    bool done = false;
+    while (!done && pos < order.size()) {
+      // Collect the next chunk, checking the bound at every new size.
+      slots.clear();
+      std::size_t checked = no_slot;
+      while (pos < order.size() && slots.size() < bound_chunk) {
+        std::size_t const k = order[pos];
+        if (part.size(k) != checked) {
+          checked = part.size(k);
+          if (hopeless(checked)) {
+            done = true;
+            break;
+          }
+        }
+        ++pos;
+        if (k != src && part.alive(k)) {
+          slots.push_back(k);
+        }
+      }
+      gather_terms(instance_num, slots, slots.size(), state);
+      pick(slots, delta_base, state, best);
+      evaluated += slots.size();
+    }
+    state.stats.evaluated += evaluated;
+    state.stats.bound_skipped += part.num_clusters() - 1 - evaluated;
+    return best;
+  };
+  std::vector<best_move> partial;
+
+  // Dirty tracking. Every delta an instance's scan computes depends only
+  // on N, the counts of its own cluster and those of the candidate. A
+  // delta is the candidate's steps A_k, what adding the instance raises
+  // its terms by, less the source's steps B, what removing it lowers them
+  // by. If the scan found no move, every delta was at most its ceiling,
+  // which is not positive, so A_k <= B_seen + ceiling. A candidate whose
+  // counts have not changed since keeps its steps while N does; when N
+  // drops from N_seen, each attribute's terms are scaled by
+  // r_j = ((T_j * Cm + N_seen) / (T_j * Cm + N))^P, largest for the
+  // smallest dataset count T_j. Its delta is then at most
+  // r_max * (B_seen + ceiling) - B, plus a rounding margin, with B the
+  // source's steps now. While that is not positive, a later scan need only
+  // score the candidates changed since, among which any positive gain, and
+  // every tie of the best one, must then be; it is skipped when there are
+  // none. With N and the source unchanged the bound is the ceiling itself.
+  //
+  // `changed_at` holds the move count at each slot's last change and a
+  // record the move count at the instance's last scan, counted from one
+  // so that zero means no usable scan; moving the instance clears it.
+  // When more than 1/dirty_ratio of the slots changed, rescoring them all
+  // costs about as much as a full scan, which is done instead.
+  bool const tracking = opts.dirty_tracking && opts.sweep == sweep_mode::sequential;
+  constexpr std::size_t dirty_ratio = 4;
+  std::size_t num_moves = 1;
+  std::vector<std::size_t> changed_at;
+  struct scan_record {
+    std::size_t seen = 0;
+    std::size_t num_clusters = 0;
+    fptype source_steps = 0;
+    fptype ceiling = 0;
+  };
+  std::vector<scan_record> records(tracking ? ds.num_instances() : 0);
+  // Collect in `state.overlap` the live slots other than `src` changed
+  // since the last scan of `instance_num` and return the ceiling of the
+  // others' deltas now; infinity if the scan cannot be reused.
+  auto const clean_ceiling = [&](std::size_t src, std::size_t instance_num, fptype delta_base,
+                                 scan_scratch &state) {
+    constexpr fptype unknown = std::numeric_limits<fptype>::infinity();
+    auto const &record = records[instance_num];
+    if (record.seen == 0 || part.num_clusters() > record.num_clusters) {
+      return unknown;
+    }
+    auto &slots = state.overlap;
+    slots.clear();
+    for (std::size_t k = 0; k < part.num_slots(); ++k) {
+      if (k != src && changed_at[k] >= record.seen && part.alive(k)) {
+        slots.push_back(k);
+      }
+    }
+    if (slots.size() * dirty_ratio >= part.num_slots()) {
+      return unknown;
+    }
+    if (changed_at[src] < record.seen && part.num_clusters() == record.num_clusters) {
+      return record.ceiling;
+    }
+    if (!(opts.power > 0) || opts.multiplier < 0) {
+      return unknown;
+    }
+    // Every delta, then and now, adds and subtracts two terms per
+    // attribute, none larger than the attribute's largest.
+    auto const attributes = ds.positive_attributes(instance_num);
+    std::size_t lowest = std::numeric_limits<std::size_t>::max();
+    fptype magnitude = std::abs(delta_base);
+    for (auto const attribute_num : attributes) {
+      std::size_t const counts_all = ds.positive_count(attribute_num);
+      lowest = std::min(lowest, counts_all);
+      magnitude += 4 * term(attribute_num, counts_all);
+    }
+    fptype const scaled = static_cast<fptype>(lowest) * opts.multiplier;
+    fptype const rescale =
+        std::pow((scaled + static_cast<fptype>(record.num_clusters)) /
+                     (scaled + static_cast<fptype>(part.num_clusters())),
+                 opts.power);
+    fptype const slack = static_cast<fptype>(8 * attributes.size() + 8) * raise.error_ulps() *
+                         std::numeric_limits<fptype>::epsilon() * (rescale + 1) * magnitude;
+    return rescale * (record.source_steps + record.ceiling) + delta_base + slack;
+  };
+
+  auto const total_stats = [&] {
+    scan_stats total;
+    for (auto const &state : scratch) {
+      total.candidates += state.stats.candidates;
+      total.evaluated += state.stats.evaluated;
+      total.bound_skipped += state.stats.bound_skipped;
+      total.unchanged_skipped += state.stats.unchanged_skipped;
+    }
+    return total;
+  };
+  // Sweep reports for opts.observer: the counters and clock at the start
+  // of the current sweep, and its moves so far.
+  std::size_t sweep = 0;
+  std::size_t sweep_moves = 0;
+  scan_stats sweep_stats;
+  auto sweep_started = std::chrono::steady_clock::now();
+  auto const begin_sweep = [&] {
+    if (opts.observer) {
+      sweep_moves = 0;
+      sweep_stats = total_stats();
+      sweep_started = std::chrono::steady_clock::now();
+    }
+  };
+  auto const end_sweep = [&] {
+    if (!opts.observer) {
+      return;
+    }
+    auto const elapsed = std::chrono::steady_clock::now() - sweep_started;
+    auto const totals = total_stats();
+    if (table) {
+      table->set_num_clusters(part.num_clusters());
+    }
+    fptype objective = 0;
+    for (std::size_t j = 0; j < ds.num_attributes(); ++j) {
+      auto const counts = part.attribute_row(j);
+      for (std::size_t k = 0; k < part.num_slots(); ++k) {
+        if (part.alive(k)) {
+          objective += term(j, counts[k]);
+        }
+      }
+    }
+    opts.observer(sweep_report<fptype>{
+        .sweep = ++sweep,
+        .num_clusters = part.num_clusters(),
+        .moves = sweep_moves,
+        .objective = objective,
+        .approximate = approximate,
+        .scan = {.candidates = totals.candidates - sweep_stats.candidates,
+                 .evaluated = totals.evaluated - sweep_stats.evaluated,
+                 .bound_skipped = totals.bound_skipped - sweep_stats.bound_skipped,
+                 .unchanged_skipped = totals.unchanged_skipped - sweep_stats.unchanged_skipped},
+        .elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)});
+  };
+
+  // Once the approximate terms find no move, switch to the exact ones and
+  // sweep again: the run ends only when an exact sweep finds no move.
+  auto const settle = [&] {
+    if (!approximate) {
+      return false;
+    }
+    approximate = false;
+    raise = exact;
+    table->set_raise(exact);
+    std::ranges::fill(records, scan_record{});
+    return true;
+  };
+
   bool changed = true;
-  while (changed) {
-    changed = false;
-    for (auto cluster_it = clusters.begin(); cluster_it != clusters.end();) {
-      auto &src = *cluster_it;
-      for (auto instance_it = src.begin(); instance_it != src.end();) {
-        auto const instance_num = *instance_it;
-        auto largest_gain = -std::numeric_limits<fptype>::infinity();
-        popc::cluster *dest = nullptr;
-        auto const delta_base =
-            compute_delta(ds, src, instance_num, clusters.size(), multiplier, power,
-                          /*added=*/false);
-        for (auto &candidate : clusters) {
-          if (&src == &candidate) {
+  if (opts.sweep == sweep_mode::batched) {
+    // Every instance in the sequential visiting order at the start of a
+    // sweep. Its slot cannot change before its own batch is applied: only
+    // the instance being applied ever moves, and slots are not compacted
+    // before the next sweep.
+    std::vector<std::size_t> work;
+    std::vector<best_move> proposals;
+    std::size_t const batch_size = std::max<std::size_t>(opts.batch_size, 1);
+    for (std::size_t k = 0; k < part.num_slots(); ++k) {
+      if (part.alive(k) && part.empty(k)) {
+        part.erase(k);
+      }
+    }
+    while (changed || settle()) {
+      changed = false;
+      begin_sweep();
+      part.compact();
+      work.clear();
+      for (std::size_t k = 0; k < part.num_slots(); ++k) {
+        for (auto const instance_num : part.members(k)) {
+          work.push_back(instance_num);
+        }
+      }
+      for (std::size_t first = 0; first < work.size(); first += batch_size) {
+        std::size_t const last = std::min(first + batch_size, work.size());
+        std::size_t const batch = last - first;
+        if (table) {
+          // Refresh every row the batch reads so the concurrent phase
+          // never writes to the table.
+          table->set_num_clusters(part.num_clusters());
+          for (std::size_t b = first; b < last; ++b) {
+            for (auto const attribute_num : ds.positive_attributes(work[b])) {
+              static_cast<void>(table->row(attribute_num));
+            }
+          }
+        }
+        proposals.assign(batch, best_move{});
+        // One contiguous share of the batch per thread, each with its own
+        // scratch accumulator.
+        std::size_t const num_tasks = std::min(batch, scratch.size());
+        auto const propose = [&](std::size_t t) {
+          for (std::size_t b = batch * t / num_tasks; b < batch * (t + 1) / num_tasks; ++b) {
+            auto const instance_num = work[first + b];
+            auto const src = part.slot_of(instance_num);
+            auto const delta_base = delta_of(src, instance_num, /*added=*/false);
+            scratch[t].stats.candidates += part.num_clusters() - 1;
+            if (prefer_sparse(instance_num)) {
+              proposals[b] = scan_sparse(src, instance_num, delta_base, scratch[t]);
+            } else if (bounded) {
+              proposals[b] = scan_bounded(src, instance_num, delta_base, scratch[t]);
+            } else {
+              proposals[b] = scan(src, instance_num, delta_base, 0, part.num_slots(), scratch[t]);
+            }
+          }
+        };
+        if (pool) {
+          pool->for_each(num_tasks, propose);
+        } else {
+          propose(0);
+        }
+        bool emptied = false;
+        for (std::size_t b = 0; b < batch; ++b) {
+          auto const &proposal = proposals[b];
+          if (!(proposal.gain > 0) || proposal.dest == no_slot) {
             continue;
           }
-          auto const delta = delta_base + compute_delta(ds, candidate, instance_num,
-                                                        clusters.size(), multiplier, power,
-                                                        /*added=*/true);
-          if (delta > largest_gain) {
-            largest_gain = delta;
-            dest = &candidate;
+          auto const instance_num = work[first + b];
+          auto const src = part.slot_of(instance_num);
+          auto const gain = delta_of(src, instance_num, /*added=*/false) +
+                            delta_of(proposal.dest, instance_num, /*added=*/true);
+          if (gain > 0) {
+            changed = true;
+            ++sweep_moves;
+            part.move(ds, instance_num, proposal.dest);
+            emptied = emptied || part.empty(src);
           }
         }
-        if (largest_gain > 0 && dest != nullptr) {
-          changed = true;
-          instance_it = src.remove_instance(instance_it);
-          dest->add_instance(instance_num);
-          std::size_t attribute_num = 0;
-          for (auto val_it = ds.cbegin(instance_num); val_it != ds.cend(instance_num); ++val_it) {
-            if (*val_it) {
-              src.decrement_attribute_count(attribute_num);
-              dest->increment_attribute_count(attribute_num);
+        if (emptied) {
+          for (std::size_t k = 0; k < part.num_slots(); ++k) {
+            if (part.alive(k) && part.empty(k)) {
+              part.erase(k);
             }
-            ++attribute_num;
           }
-        } else {
-          ++instance_it;
         }
       }
-      if (src.empty()) {
-        cluster_it = clusters.erase(cluster_it);
-      } else {
-        ++cluster_it;
+      end_sweep();
+    }
+  } else {
+    while (changed || settle()) {
+      changed = false;
+      begin_sweep();
+      if (tracking) {
+        // Follow the slots through compact(), which keeps them in order.
+        changed_at.resize(part.num_slots());
+        std::size_t live = 0;
+        for (std::size_t k = 0; k < part.num_slots(); ++k) {
+          if (part.alive(k)) {
+            changed_at[live++] = changed_at[k];
+          }
+        }
+        changed_at.resize(live);
       }
+      part.compact();
+      std::size_t const num_candidates = part.num_slots();
+      std::size_t const num_tasks =
+          pool ? std::clamp<std::size_t>(num_candidates / min_candidates_per_task, 1,
+                                         pool->size())
+               : 1;
+      for (std::size_t src = 0; src < num_candidates; ++src) {
+        if (table) {
+          table->set_num_clusters(part.num_clusters());
+        }
+        auto const members = part.members(src);
+        for (auto instance_it = members.begin(); instance_it != members.end();) {
+          // Advance first: a move re-links the instance into `best.dest`.
+          auto const instance_num = *instance_it++;
+          auto &state = scratch[0];
+          state.stats.candidates += part.num_clusters() - 1;
+          // Computed serially first: with the table engine this also
+          // refreshes every row the concurrent scan reads, so the workers
+          // never write to the table.
+          auto const delta_base = delta_of(src, instance_num, /*added=*/false);
+          fptype const clean = tracking ? clean_ceiling(src, instance_num, delta_base, state)
+                                        : std::numeric_limits<fptype>::infinity();
+          best_move best;
+          fptype ceiling = best.gain;
+          if (!(clean > 0) && state.overlap.empty()) {
+            // Nothing it could move to has changed: keep the record.
+            records[instance_num].seen = num_moves;
+            state.stats.unchanged_skipped += part.num_clusters() - 1;
+            continue;
+          }
+          if (!(clean > 0)) {
+            gather_terms(instance_num, state.overlap, state.overlap.size(), state);
+            pick(state.overlap, delta_base, state, best);
+            ceiling = clean;
+            state.stats.evaluated += state.overlap.size();
+            state.stats.unchanged_skipped += part.num_clusters() - 1 - state.overlap.size();
+          } else if (prefer_sparse(instance_num)) {
+            best = scan_sparse(src, instance_num, delta_base, state);
+          } else if (bounded && num_tasks == 1) {
+            best = scan_bounded(src, instance_num, delta_base, state);
+            ceiling = state.ceiling;
+          } else if (num_tasks == 1) {
+            best = scan(src, instance_num, delta_base, 0, num_candidates, state);
+          } else {
+            partial.assign(num_tasks, best_move{});
+            pool->for_each(num_tasks, [&](std::size_t k) {
+              partial[k] = scan(src, instance_num, delta_base, num_candidates * k / num_tasks,
+                                num_candidates * (k + 1) / num_tasks, scratch[k]);
+            });
+            for (auto const &p : partial) {
+              if (p.gain > best.gain) {
+                best = p;
+              }
+            }
+          }
+          if (tracking) {
+            records[instance_num] = {.seen = num_moves,
+                                     .num_clusters = part.num_clusters(),
+                                     .source_steps = -delta_base,
+                                     .ceiling = std::max(ceiling, best.gain)};
+          }
+          if (best.gain > 0 && best.dest != no_slot) {
+            changed = true;
+            ++sweep_moves;
+            part.move(ds, instance_num, best.dest);
+            if (tracking) {
+              records[instance_num].seen = 0;
+              changed_at[src] = num_moves;
+              changed_at[best.dest] = num_moves;
+              ++num_moves;
+            }
+          }
+        }
+        if (part.empty(src)) {
+          part.erase(src);
+        }
+      }
+      end_sweep();
     }
   }
-  std::vector<std::size_t> labels(ds.num_instances());
-  std::size_t cluster_index = 0;
-  for (auto const &c : clusters) {
-    for (auto it = c.cbegin(); it != c.cend(); ++it) {
-      labels[*it] = cluster_index;
-    }
-    ++cluster_index;
+  if (opts.stats != nullptr) {
+    *opts.stats = total_stats();
   }
+  part.compact();
+  return part.labels();
+}
+
+/**
+ * @brief popc() on a list of clusters.
+ *
+ * Copies `clusters` into a popc::partition (list order becomes slot
+ * order), runs the partition overload, and replaces the list with the
+ * resulting clusters, so callers holding a `std::list<popc::cluster>` see
+ * the same in-place behaviour as before the partition existed.
+ *
+ * @tparam fptype     Floating-point type for the probability arithmetic.
+ * @param ds          Source dataset.
+ * @param clusters    Seeded partition. Each cluster's `attribute_counts`
+ *                    must already match its members. Replaced by the
+ *                    result.
+ * @param opts        Hyperparameters, evaluation strategy and thread
+ *                    count.
+ *
+ * @return Vector of size `ds.num_instances()` mapping each instance index
+ *         to its final cluster index in `[0, clusters.size())`. Cluster
+ *         indices are assigned in the order in which the clusters appear
+ *         in `clusters` at return time.
+ *
+ * @throws std::logic_error if `ds` has more instances than
+ *         popc::partition::count_type can count.
+ */
+template <typename fptype>
+[[nodiscard]] std::vector<std::size_t> popc(popc::dataset const &ds,
+                                            std::list<popc::cluster> &clusters,
+                                            options<fptype> const &opts) {
+  popc::partition part{ds, clusters};
+  auto labels = popc(ds, part, opts);
+  clusters = part.to_clusters();
   return labels;
 }
 
+/**
+ * @brief Convenience overload of popc() taking the hyperparameters directly.
+ *
+ * Equivalent to calling the options overload with `multiplier` and `power`
+ * and the default (table-driven) engine.
+ *
+ * @tparam fptype     Floating-point type for the probability arithmetic.
+ * @param ds          Source dataset.
+ * @param clusters    Seeded partition. Mutated in place.
+ * @param multiplier  The `Cm` hyperparameter (defaults to the paper's 1000).
+ * @param power       The `P` hyperparameter (defaults to the paper's 10).
+ *
+ * @return Cluster label per instance; see the options overload.
+ */
+template <typename fptype = double>
+[[nodiscard]] std::vector<std::size_t>
+popc(popc::dataset const &ds, std::list<popc::cluster> &clusters,
+     fptype multiplier = static_cast<fptype>(1000), fptype power = static_cast<fptype>(10)) {
+  return popc(ds, clusters, options<fptype>{.multiplier = multiplier, .power = power});
+}
+
 } // namespace popc
 
 #endif // POPC_POPC_HPP
@@ -0,0 +1,54 @@
+#ifndef POPC_SRC_CLI_HPP
+#define POPC_SRC_CLI_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+// Command-line helpers shared by the popc, popc-gen and popc-bench
+// executables. Not part of the installed library; kept in one place so the
+// three tools parse and report their arguments the same way.
+
+namespace popc::cli {
+
+/**
+ * @brief Print the one-line usage hint to stderr.
+ *
+ * @param program  `argv[0]`.
+ * @param synopsis Operand summary following the program name, such as
+ *                 `"[OPTION]... [FILE]"`.
+ */
+inline void short_usage(char const *program, char const *synopsis) {
+  std::cerr << "Usage: " << program << ' ' << synopsis << '\n'
+            << "Try '" << program << " --help' for more information.\n";
+}
+
+/**
+ * @brief Strict parser for non-negative integer command-line arguments.
+ *
+ * Accepts a decimal integer with no sign, no trailing garbage, and no
+ * overflow.
+ *
+ * @param arg Null-terminated input string.
+ * @param out On success, receives the parsed value. Unmodified on failure.
+ * @return `true` if `arg` was fully consumed as a valid count.
+ */
+inline bool parse_size(char const *arg, std::size_t &out) {
+  if (*arg < '0' || *arg > '9') {
+    return false;
+  }
+  char *end = nullptr;
+  errno = 0;
+  unsigned long long const v = std::strtoull(arg, &end, 10);
+  if (errno != 0 || *end != '\0' || v > std::numeric_limits<std::size_t>::max()) {
+    return false;
+  }
+  out = static_cast<std::size_t>(v);
+  return true;
+}
+
+} // namespace popc::cli
+
+#endif // POPC_SRC_CLI_HPP
@@ -1,34 +1,50 @@
 #include <algorithm>
 #include <cerrno>
+#include <cmath>
 #include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <exception>
+#include <filesystem>
+#include <functional>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <iterator>
 #include <limits>
 #include <list>
+#include <optional>
+#include <random>
 #include <stack>
 #include <stdexcept>
 #include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <getopt.h>
 
-#include <popc/cluster.hpp>
 #include <popc/dataset.hpp>
 #include <popc/detail/bitpacked_kmeans.hpp>
+#include <popc/detail/mapped_file.hpp>
+#include <popc/partition.hpp>
 #include <popc/popc.hpp>
 
+#include "cli.hpp"
+
 #ifndef POPC_VERSION
 #define POPC_VERSION "unknown"
 #endif
 
 namespace {
 
+using popc::cli::parse_size;
+using popc::cli::short_usage;
+
+/** @brief Operand summary shown after the program name in usage text. */
+constexpr char const *synopsis = "[OPTION]... [FILE]";
+
 /** @brief Logging severity threshold; filters which messages reach stderr. */
 enum verbosity_level : char {
   QUIET = 0,
@@ -56,30 +72,45 @@ enum message_type : char {
 char DELIMITER = '\t';
 verbosity_level VERBOSITY = WARNING;
 
-/** @brief Print the one-line usage hint to stderr. */
-void short_usage(char const *program) {
-  std::cerr << "Usage: " << program << " [OPTION]... [FILE]\n"
-            << "Try '" << program << " --help' for more information.\n";
-}
-
 /** @brief Print the full `--help` usage text to stderr. */
 void usage(char const *program) {
   std::cerr
-      << "Usage: " << program << " [OPTION]... [FILE]\n"
+      << "Usage: " << program << ' ' << synopsis << '\n'
       << "Generate POPC cluster assignments from input. Input may be taken either from\n"
-      << "standard input or from [FILE] if standard input is not provided. Input is read\n"
-      << "once as a stream, so named pipes and process substitution may also be used as\n"
-      << "the [FILE] argument. Input must be tabular data in the form of Boolean (0 or 1)\n"
-      << "values separated by tab, or CHAR if specified. Data must be preceded by a\n"
-      << "single-line header naming the columns. Output takes the form of a single integer\n"
-      << "cluster assignment per line, where each line corresponds to the data row of the\n"
-      << "input.\n"
+      << "standard input or from [FILE] if standard input is not provided. A regular\n"
+      << "[FILE] is memory-mapped and parsed in place; standard input, named pipes and\n"
+      << "process substitution are read once as a stream. Input must be tabular data in\n"
+      << "the form of Boolean (0 or 1) values separated by tab, or CHAR if specified.\n"
+      << "Data must be preceded by a single-line header naming the columns. Output takes\n"
+      << "the form of a single integer cluster assignment per line, where each line\n"
+      << "corresponds to the data row of the input. A regular [FILE] in the binary\n"
+      << "dataset format written by --convert is loaded in place without parsing.\n"
       << "\n"
       << "  -t, --delimiter=CHAR      use CHAR for field separator (default: TAB)\n"
+      << "  -b, --convert=BFILE       write the input to BFILE in the binary dataset\n"
+      << "                            format and exit without clustering\n"
       << "  -c, --clusters=CFILE      read pre-computed cluster assignments from CFILE\n"
       << "                            (one cluster identifier per line, ordered by instance)\n"
       << "  -m, --multiplier=MULT     multiplying constant C_m (default: 1000.0)\n"
-      << "  -p, --power=POW           power constant P (default: 10.0)\n"
+      << "  -p, --power=POW           power constant P (default: 10.0); an integral P of\n"
+      << "                            at most 64 is evaluated by repeated squaring\n"
+      << "  -e, --engine=ENGINE       delta evaluation engine, one of {table,pow}\n"
+      << "                            (default: table; both give identical results)\n"
+      << "  -a, --approx              score moves with approximate powers until they\n"
+      << "                            converge, then refine with exact ones; the result\n"
+      << "                            is still a local optimum of the exact objective.\n"
+      << "                            Mostly useful for a fractional P\n"
+      << "  -j, --threads=N           use N threads for parsing, seeding and refinement;\n"
+      << "                            0 means one per hardware thread (default: 1)\n"
+      << "  -s, --sweep=MODE          move evaluation order, one of {sequential,batched};\n"
+      << "                            batched evaluates each batch of instances in\n"
+      << "                            parallel against frozen counts (default: sequential)\n"
+      << "  -B, --batch-size=N        instances per batch with --sweep=batched\n"
+      << "                            (default: 4096)\n"
+      << "      --stats=FILE          write one JSON object per refinement sweep to FILE:\n"
+      << "                            sweep, clusters, moves, objective, approximate,\n"
+      << "                            candidates, evaluated, bound_skipped,\n"
+      << "                            unchanged_skipped and seconds\n"
       << "  -v, --verbosity=VALUE     one of {0,1,2,3,quiet,warning,info,debug} (default: 1)\n"
       << "  -h, --help                display this help and exit\n"
       << "  -V, --version             output version information and exit\n";
@@ -177,6 +208,61 @@ bool parse_verbosity(char const *arg, verbosity_level &out) {
   return true;
 }
 
+/**
+ * @brief Parse the `--threads` argument.
+ *
+ * Like parse_size(), but `0` selects one thread per hardware thread.
+ *
+ * @param arg Null-terminated input string.
+ * @param out On success, receives the thread count (never 0). Unmodified
+ *            on failure.
+ * @return `true` if `arg` was fully consumed as a valid count.
+ */
+bool parse_threads(char const *arg, std::size_t &out) {
+  std::size_t v = 0;
+  if (!parse_size(arg, v)) {
+    return false;
+  }
+  out = v == 0 ? std::max<std::size_t>(std::thread::hardware_concurrency(), 1) : v;
+  return true;
+}
+
+/**
+ * @brief Parse the `--sweep` argument into a popc::sweep_mode.
+ *
+ * @param arg Null-terminated input string.
+ * @param out On success, receives the parsed mode. Unmodified on failure.
+ * @return `true` if `arg` named one of the recognized sweep modes.
+ */
+bool parse_sweep(char const *arg, popc::sweep_mode &out) {
+  if (std::strcmp(arg, "sequential") == 0) {
+    out = popc::sweep_mode::sequential;
+  } else if (std::strcmp(arg, "batched") == 0) {
+    out = popc::sweep_mode::batched;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Parse the `--engine` argument into a popc::delta_engine.
+ *
+ * @param arg Null-terminated input string.
+ * @param out On success, receives the parsed engine. Unmodified on failure.
+ * @return `true` if `arg` named one of the recognized engines.
+ */
+bool parse_engine(char const *arg, popc::delta_engine &out) {
+  if (std::strcmp(arg, "table") == 0) {
+    out = popc::delta_engine::table;
+  } else if (std::strcmp(arg, "pow") == 0) {
+    out = popc::delta_engine::pow;
+  } else {
+    return false;
+  }
+  return true;
+}
+
 } // namespace
 
 namespace {
@@ -198,14 +284,28 @@ int run(int argc, char *argv[]) {
   std::ios_base::sync_with_stdio(false);
 
   char const *cfile = nullptr;
+  char const *convert_file = nullptr;
+  char const *stats_file = nullptr;
   double multiplier = 1000.0;
   double power = 10.0;
+  popc::delta_engine engine = popc::delta_engine::table;
+  bool approx = false;
+  std::size_t num_threads = popc::options<double>{}.num_threads;
+  popc::sweep_mode sweep = popc::sweep_mode::sequential;
+  std::size_t batch_size = popc::options<double>{}.batch_size;
 
   static option const long_options[] = {
       {.name = "delimiter", .has_arg = required_argument, .flag = nullptr, .val = 't'},
+      {.name = "convert", .has_arg = required_argument, .flag = nullptr, .val = 'b'},
       {.name = "clusters", .has_arg = required_argument, .flag = nullptr, .val = 'c'},
       {.name = "multiplier", .has_arg = required_argument, .flag = nullptr, .val = 'm'},
       {.name = "power", .has_arg = required_argument, .flag = nullptr, .val = 'p'},
+      {.name = "engine", .has_arg = required_argument, .flag = nullptr, .val = 'e'},
+      {.name = "approx", .has_arg = no_argument, .flag = nullptr, .val = 'a'},
+      {.name = "threads", .has_arg = required_argument, .flag = nullptr, .val = 'j'},
+      {.name = "sweep", .has_arg = required_argument, .flag = nullptr, .val = 's'},
+      {.name = "batch-size", .has_arg = required_argument, .flag = nullptr, .val = 'B'},
+      {.name = "stats", .has_arg = required_argument, .flag = nullptr, .val = 'S'},
       {.name = "verbosity", .has_arg = required_argument, .flag = nullptr, .val = 'v'},
       {.name = "help", .has_arg = no_argument, .flag = nullptr, .val = 'h'},
       {.name = "version", .has_arg = no_argument, .flag = nullptr, .val = 'V'},
@@ -214,7 +314,7 @@ int run(int argc, char *argv[]) {
 
   while (true) {
     int option_index = 0;
-    int const c = getopt_long(argc, argv, "t:c:m:p:v:hV", long_options, &option_index);
+    int const c = getopt_long(argc, argv, "t:b:c:m:p:e:aj:s:B:v:hV", long_options, &option_index);
     if (c == -1) {
       break;
     }
@@ -229,6 +329,9 @@ int run(int argc, char *argv[]) {
         DELIMITER = optarg[0];
       }
       break;
+    case 'b':
+      convert_file = optarg;
+      break;
     case 'c':
       cfile = optarg;
       break;
@@ -244,12 +347,46 @@ int run(int argc, char *argv[]) {
         return 1;
       }
       break;
+    case 'e':
+      if (!parse_engine(optarg, engine)) {
+        std::cerr << argv[0] << ": -e, --engine=ENGINE must be one of {table,pow}\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 'a':
+      approx = true;
+      break;
+    case 'j':
+      if (!parse_threads(optarg, num_threads)) {
+        std::cerr << argv[0] << ": -j, --threads=N must be a non-negative integer\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 's':
+      if (!parse_sweep(optarg, sweep)) {
+        std::cerr << argv[0] << ": -s, --sweep=MODE must be one of {sequential,batched}\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 'B':
+      if (!parse_size(optarg, batch_size) || batch_size == 0) {
+        std::cerr << argv[0] << ": -B, --batch-size=N must be a positive integer\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 'S':
+      stats_file = optarg;
+      break;
     case 'v':
       if (!parse_verbosity(optarg, VERBOSITY)) {
         std::cerr << argv[0]
                   << ": -v, --verbosity=VALUE must be one of "
                      "{0,1,2,3,quiet,warning,info,debug}\n";
-        short_usage(argv[0]);
+        short_usage(argv[0], synopsis);
         return 1;
       }
       break;
@@ -260,22 +397,52 @@ int run(int argc, char *argv[]) {
       std::cout << "POPC C++ by Ryan N. Lichtenwalter v" << POPC_VERSION << "\n";
       return 0;
     default:
-      short_usage(argv[0]);
+      short_usage(argv[0], synopsis);
       return 1;
     }
   }
 
+  if (approx && (multiplier < 0 || power < 0)) {
+    std::cerr << argv[0] << ": -a, --approx requires a non-negative multiplier and power\n";
+    short_usage(argv[0], synopsis);
+    return 1;
+  }
+
+  std::ofstream stats_out;
+  if (stats_file != nullptr) {
+    stats_out.open(stats_file);
+    if (!stats_out.is_open()) {
+      std::cerr << argv[0] << ": cannot open stats file: " << stats_file << "\n";
+      return 2;
+    }
+  }
+
+  // Regular files are memory-mapped and parsed straight out of the
+  // mapping; anything else (FIFOs, process substitution, stdin) goes
+  // through the stream parser.
   std::ifstream ifs;
+  std::optional<popc::detail::mapped_file> mapped;
   if (optind < argc) {
     if (optind != argc - 1) {
       std::cerr << argv[0] << ": too many arguments\n";
-      short_usage(argv[0]);
+      short_usage(argv[0], synopsis);
       return 1;
     }
-    ifs.open(argv[optind]);
-    if (!ifs.is_open()) {
-      std::cerr << argv[0] << ": cannot open file: " << argv[optind] << "\n";
-      return 2;
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(argv[optind], ec)) {
+      try {
+        mapped.emplace(argv[optind]);
+      } catch (std::system_error const &e) {
+        std::cerr << argv[0] << ": cannot open file: " << argv[optind] << " (" << e.what()
+                  << ")\n";
+        return 2;
+      }
+    } else {
+      ifs.open(argv[optind]);
+      if (!ifs.is_open()) {
+        std::cerr << argv[0] << ": cannot open file: " << argv[optind] << "\n";
+        return 2;
+      }
     }
     log_message((std::string{"FILE = "} + argv[optind]).c_str(), DEBUG, STANDARD);
   }
@@ -283,7 +450,15 @@ int run(int argc, char *argv[]) {
   log_message("Reading data...", INFO, START);
   popc::dataset data;
   try {
-    if (ifs.is_open()) {
+    if (mapped && popc::dataset::is_binary(mapped->view())) {
+      log_message("Loading binary dataset...", DEBUG, STANDARD);
+      data = popc::dataset{popc::binary_format, std::move(*mapped)};
+      mapped.reset();
+    } else if (mapped) {
+      log_message("Reading from memory-mapped file...", DEBUG, STANDARD);
+      data = popc::dataset{mapped->view(), DELIMITER, num_threads};
+      mapped.reset();
+    } else if (ifs.is_open()) {
       log_message("Reading from file...", DEBUG, STANDARD);
       data = popc::dataset{ifs, DELIMITER};
       ifs.close();
@@ -297,6 +472,27 @@ int run(int argc, char *argv[]) {
   }
   log_message("DONE", INFO, FINISH);
 
+  if (convert_file != nullptr) {
+    log_message("Writing binary dataset...", INFO, START);
+    std::ofstream bfile{convert_file, std::ios::binary | std::ios::trunc};
+    if (!bfile.is_open()) {
+      std::cerr << argv[0] << ": cannot open output file: " << convert_file << "\n";
+      return 2;
+    }
+    try {
+      data.write_binary(bfile);
+      bfile.close();
+      if (!bfile) {
+        throw std::runtime_error{"failed to write binary dataset"};
+      }
+    } catch (std::exception const &e) {
+      std::cerr << argv[0] << ": " << convert_file << ": " << e.what() << "\n";
+      return 2;
+    }
+    log_message("DONE", INFO, FINISH);
+    return 0;
+  }
+
   std::size_t const initial_num_clusters = data.num_instances() / 2;
   std::vector<std::size_t> assignments(data.num_instances());
 
@@ -328,14 +524,27 @@ int run(int argc, char *argv[]) {
     log_message("DONE", INFO, FINISH);
   } else {
     log_message("Performing bitpacked k-modes seed...", INFO, START);
-    assignments = popc::detail::bitpacked_kmodes_seed(data, initial_num_clusters);
+    popc::detail::kmodes_stats seed_stats;
+    assignments = popc::detail::bitpacked_kmodes_seed(data, initial_num_clusters, 32,
+                                                      std::random_device{}(), num_threads,
+                                                      &seed_stats);
     log_message("DONE", INFO, FINISH);
+    std::size_t const skipped = seed_stats.bound_skipped + seed_stats.tightened_skipped;
+    log_message(("Seed iterations: " + std::to_string(seed_stats.iterations) +
+                 ", centroid searches skipped by bounds: " + std::to_string(skipped) + " of " +
+                 std::to_string(seed_stats.assignments) + " (" +
+                 std::to_string(seed_stats.assignments == 0
+                                    ? 0
+                                    : 100 * skipped / seed_stats.assignments) +
+                 "%)")
+                    .c_str(),
+                DEBUG, STANDARD);
   }
 
   // The seed assignment may use cluster identifiers larger than the number
   // of distinct clusters used (e.g. user-supplied cluster file with sparse
-  // numbering). Compact to dense [0, k) so the cluster vector size below is
-  // tight and the popc loop's clusters.size() reflects reality.
+  // numbering). Compact to dense [0, k) so the partition below has no
+  // empty slots and the popc loop's cluster count reflects reality.
   if (assignments.empty()) {
     return 0;
   }
@@ -354,24 +563,63 @@ int run(int argc, char *argv[]) {
   }
 
   log_message("Processing cluster assignments...", INFO, START);
-  std::vector<popc::cluster> clusters_vec(actual_num_clusters,
-                                          popc::cluster{data.num_attributes()});
-  for (std::size_t i = 0; i < assignments.size(); ++i) {
-    auto &cluster = clusters_vec[assignments[i]];
-    cluster.add_instance(i);
-    for (std::size_t j = 0; j < data.num_attributes(); ++j) {
-      if (data(i, j)) {
-        cluster.increment_attribute_count(j);
-      }
-    }
-  }
+  popc::partition part{data, assignments};
   log_message("DONE", INFO, FINISH);
 
+  // Integral powers, the paper's default included, are raised by repeated
+  // squaring rather than std::pow.
+  bool const integer_power = power >= 0 &&
+                             power <= static_cast<double>(popc::detail::max_integer_power) &&
+                             power == std::floor(power);
+  log_message(integer_power ? "Raising probabilities by repeated squaring"
+                            : "Raising probabilities with std::pow",
+              DEBUG, STANDARD);
+  // The approximation mainly pays off for fractional powers, which would
+  // otherwise call std::pow, but it is honoured whenever it is requested.
+  if (approx) {
+    log_message("Approximating probabilities until the first fixed point", DEBUG, STANDARD);
+    engine = popc::delta_engine::approx;
+  }
+
+  // One JSON object per line, flushed as each sweep ends so long runs
+  // can be followed while they are still going.
+  std::function<void(popc::sweep_report<double> const &)> sweep_observer;
+  if (stats_out.is_open()) {
+    sweep_observer = [&stats_out](popc::sweep_report<double> const &report) {
+      stats_out << "{\"sweep\":" << report.sweep << ",\"clusters\":" << report.num_clusters
+                << ",\"moves\":" << report.moves << ",\"objective\":"
+                << std::setprecision(std::numeric_limits<double>::max_digits10)
+                << report.objective << std::setprecision(6)
+                << ",\"approximate\":" << (report.approximate ? "true" : "false")
+                << ",\"candidates\":" << report.scan.candidates
+                << ",\"evaluated\":" << report.scan.evaluated
+                << ",\"bound_skipped\":" << report.scan.bound_skipped
+                << ",\"unchanged_skipped\":" << report.scan.unchanged_skipped
+                << ",\"seconds\":" << std::chrono::duration<double>(report.elapsed).count()
+                << "}" << std::endl;
+    };
+  }
+
   log_message("Executing POPC algorithm...", INFO, START);
-  std::list<popc::cluster> clusters_list;
-  std::ranges::move(clusters_vec, std::back_inserter(clusters_list));
-  auto const result = popc::popc(data, clusters_list, multiplier, power);
+  popc::scan_stats stats;
+  auto const result = popc::popc(
+      data, part,
+      popc::options<double>{.multiplier = multiplier,
+                            .power = power,
+                            .engine = engine,
+                            .integer_power = integer_power,
+                            .num_threads = num_threads,
+                            .sweep = sweep,
+                            .batch_size = batch_size,
+                            .stats = &stats,
+                            .observer = sweep_observer});
   log_message("DONE", INFO, FINISH);
+  log_message(("Candidates: " + std::to_string(stats.candidates) +
+               ", evaluated: " + std::to_string(stats.evaluated) +
+               ", skipped by bound: " + std::to_string(stats.bound_skipped) +
+               ", skipped as unchanged: " + std::to_string(stats.unchanged_skipped))
+                  .c_str(),
+              DEBUG, STANDARD);
 
   log_message("Outputting results...", INFO, START);
   for (auto const val : result) {
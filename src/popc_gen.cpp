@@ -0,0 +1,519 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <getopt.h>
+
+#include <popc/dataset.hpp>
+#include <popc/detail/binary_format.hpp>
+#include <popc/detail/planted_partition.hpp>
+#include <popc/detail/thread_pool.hpp>
+
+#include "cli.hpp"
+
+#ifndef POPC_VERSION
+#define POPC_VERSION "unknown"
+#endif
+
+namespace {
+
+using popc::cli::parse_size;
+using popc::cli::short_usage;
+
+/** @brief Operand summary shown after the program name in usage text. */
+constexpr char const *synopsis = "[OPTION]...";
+
+using word_type = popc::detail::planted_partition::word_type;
+
+/** @brief Output encodings of the generated rows. */
+enum class output_format : char {
+  tsv,
+  binary,
+};
+
+/** @brief Approximate bytes of rows each task generates per round. */
+constexpr std::size_t task_bytes = std::size_t{1} << 20;
+
+/** @brief Print the full `--help` usage text to stderr. */
+void usage(char const *program) {
+  std::cerr
+      << "Usage: " << program << ' ' << synopsis << '\n'
+      << "Generate binary-feature data with planted clusters. Each of K clusters marks\n"
+      << "every attribute as characteristic with probability DENSITY; its members have a\n"
+      << "characteristic attribute set with probability P_IN and any other with probability\n"
+      << "P_OUT, and every bit is then flipped with probability NOISE. Instances belong to a\n"
+      << "uniformly chosen cluster. Output is the text format popc reads, or its binary\n"
+      << "format; the planted labels can be written alongside, one per line. The output\n"
+      << "depends only on the options, not on the number of threads.\n\n"
+      << "  -n, --instances=N       number of instances (default 1000)\n"
+      << "  -f, --attributes=F      number of attributes (default 100)\n"
+      << "  -k, --clusters=K        number of planted clusters (default 10)\n"
+      << "  -d, --density=DENSITY   fraction of characteristic attributes per cluster\n"
+      << "                            (default 0.1)\n"
+      << "  -i, --p-in=P_IN         probability of a characteristic attribute (default 0.8)\n"
+      << "  -u, --p-out=P_OUT       probability of any other attribute (default 0.05)\n"
+      << "  -e, --noise=NOISE       probability of flipping each bit (default 0)\n"
+      << "  -s, --seed=SEED         seed of the model and the instances (default 1)\n"
+      << "  -o, --output=FILE       write the data to FILE instead of standard output\n"
+      << "  -l, --labels=LFILE      write the planted label of each instance to LFILE\n"
+      << "  -F, --format=FORMAT     one of {tsv,binary} (default tsv); binary requires\n"
+      << "                            --output\n"
+      << "  -t, --delimiter=CHAR    text column separator (default tab)\n"
+      << "  -j, --threads=N         generate on N threads (default: one per hardware\n"
+      << "                            thread; 0 means the same)\n"
+      << "  -h, --help              display this help and exit\n"
+      << "  -V, --version           output version information and exit\n";
+}
+
+/**
+ * @brief Parse a probability in `[0, 1]`.
+ *
+ * @param arg Null-terminated input string.
+ * @param out On success, receives the parsed value. Unmodified on failure.
+ * @return `true` if `arg` was fully consumed as a number in `[0, 1]`.
+ */
+bool parse_probability(char const *arg, double &out) {
+  char *end = nullptr;
+  errno = 0;
+  double const v = std::strtod(arg, &end);
+  if (errno != 0 || end == arg || *end != '\0' || !(v >= 0 && v <= 1)) {
+    return false;
+  }
+  out = v;
+  return true;
+}
+
+/**
+ * @brief Text of every byte of row bits: eight values each followed by a delimiter.
+ *
+ * Formatting a row then costs one 16-byte copy per eight attributes.
+ */
+std::array<std::array<char, 16>, 256> make_byte_text(char delimiter) {
+  std::array<std::array<char, 16>, 256> table{};
+  for (std::size_t byte = 0; byte < 256; ++byte) {
+    for (std::size_t b = 0; b < 8; ++b) {
+      table[byte][2 * b] = ((byte >> b) & 1U) != 0 ? '1' : '0';
+      table[byte][2 * b + 1] = delimiter;
+    }
+  }
+  return table;
+}
+
+/** @brief Generated output of one task: a contiguous range of instances. */
+struct chunk {
+  std::string data;
+  std::string labels;
+  /** Per-attribute positives of the range; binary format only. */
+  std::vector<std::uint64_t> positive_counts;
+};
+
+/** @brief Streams the instances of a planted_partition in fixed-size rounds of chunks. */
+class generator {
+public:
+  generator(popc::detail::planted_partition const &model, output_format format, char delimiter,
+            bool with_labels)
+      : model_{model}, format_{format}, with_labels_{with_labels},
+        byte_text_{make_byte_text(delimiter)} {}
+
+  /** @brief Return the bytes one row occupies in the output. */
+  [[nodiscard]] std::size_t row_bytes() const noexcept {
+    return format_ == output_format::tsv ? 2 * model_.num_attributes()
+                                         : model_.words_per_instance() * sizeof(word_type);
+  }
+
+  /** @brief Generate instances `[first, first + count)` into `out`. */
+  void fill(std::uint64_t first, std::size_t count, chunk &out) const {
+    std::size_t const f = model_.num_attributes();
+    std::size_t const wpi = model_.words_per_instance();
+    std::vector<word_type> row(wpi);
+    out.data.resize(count * row_bytes());
+    out.labels.clear();
+    if (format_ == output_format::binary) {
+      out.positive_counts.assign(f, 0);
+    }
+    char *dst = out.data.data();
+    for (std::size_t r = 0; r < count; ++r) {
+      std::size_t const label = model_.generate(first + r, row);
+      if (with_labels_) {
+        out.labels += std::to_string(label);
+        out.labels += '\n';
+      }
+      if (format_ == output_format::binary) {
+        std::memcpy(dst, row.data(), wpi * sizeof(word_type));
+        dst += wpi * sizeof(word_type);
+        for (std::size_t w = 0; w < wpi; ++w) {
+          for (word_type bits = row[w]; bits != 0; bits &= bits - 1) {
+            ++out.positive_counts[w * popc::dataset::bits_per_word +
+                                  static_cast<std::size_t>(std::countr_zero(bits))];
+          }
+        }
+        continue;
+      }
+      // Whole bytes first, then the tail; the last delimiter ends the line.
+      std::size_t j = 0;
+      for (; j + 8 <= f; j += 8) {
+        auto const byte = (row[j / 64] >> (j % 64)) & 0xFFU;
+        std::memcpy(dst, byte_text_[byte].data(), 16);
+        dst += 16;
+      }
+      if (j < f) {
+        auto const byte = (row[j / 64] >> (j % 64)) & 0xFFU;
+        std::memcpy(dst, byte_text_[byte].data(), 2 * (f - j));
+        dst += 2 * (f - j);
+      }
+      dst[-1] = '\n';
+    }
+  }
+
+private:
+  popc::detail::planted_partition const &model_;
+  output_format format_;
+  bool with_labels_;
+  std::array<std::array<char, 16>, 256> byte_text_;
+};
+
+/**
+ * @brief Write everything of the binary format before the row words.
+ *
+ * The header's `num_positive` and the positive counts are not known until
+ * every row is generated; they are written as zero here and patched by
+ * finish_binary().
+ *
+ * @return Byte offsets of the file's sections.
+ */
+popc::detail::binary_layout start_binary(std::ostream &os, popc::detail::binary_header &header,
+                                         std::size_t num_instances, std::size_t num_attributes,
+                                         std::size_t words_per_instance) {
+  std::vector<std::string> names;
+  std::vector<std::uint64_t> name_offsets{0};
+  for (std::size_t j = 0; j < num_attributes; ++j) {
+    names.push_back("attr" + std::to_string(j + 1));
+    name_offsets.push_back(name_offsets.back() + names.back().size());
+  }
+  header.magic = popc::detail::binary_magic;
+  header.byte_order = popc::detail::binary_byte_order_mark;
+  header.version = popc::detail::binary_version;
+  header.flags = 0;
+  header.num_instances = num_instances;
+  header.num_attributes = num_attributes;
+  header.words_per_instance = words_per_instance;
+  header.num_positive = 0;
+  header.names_bytes = name_offsets.back();
+  auto const layout = popc::detail::compute_binary_layout(header);
+  if (!layout) {
+    throw std::runtime_error{"dataset is too large for the binary format"};
+  }
+
+  std::size_t written = 0;
+  auto const pad_to = [&](std::size_t offset) {
+    static constexpr char zeros[8]{};
+    os.write(zeros, static_cast<std::streamsize>(offset - written));
+    written = offset;
+  };
+  auto const put = [&](std::size_t offset, void const *data, std::size_t size) {
+    pad_to(offset);
+    os.write(static_cast<char const *>(data), static_cast<std::streamsize>(size));
+    written = offset + size;
+  };
+  put(0, &header, sizeof(header));
+  put(layout->name_offsets, name_offsets.data(), name_offsets.size() * sizeof(std::uint64_t));
+  std::size_t names_written = layout->names;
+  for (auto const &name : names) {
+    put(names_written, name.data(), name.size());
+    names_written += name.size();
+  }
+  std::vector<std::uint64_t> const zero_counts(num_attributes, 0);
+  put(layout->positive_counts, zero_counts.data(), zero_counts.size() * sizeof(std::uint64_t));
+  pad_to(layout->words);
+  return *layout;
+}
+
+/**
+ * @brief Patch the positive counts and their total into a binary file
+ *        written by start_binary().
+ */
+void finish_binary(std::ostream &os, popc::detail::binary_header &header,
+                   popc::detail::binary_layout const &layout,
+                   std::vector<std::uint64_t> const &positive_counts) {
+  header.num_positive = 0;
+  for (auto const count : positive_counts) {
+    header.num_positive += count;
+  }
+  os.seekp(0);
+  os.write(reinterpret_cast<char const *>(&header), sizeof(header));
+  os.seekp(static_cast<std::streamoff>(layout.positive_counts));
+  os.write(reinterpret_cast<char const *>(positive_counts.data()),
+           static_cast<std::streamsize>(positive_counts.size() * sizeof(std::uint64_t)));
+}
+
+/**
+ * @brief Generator entry point separated from `main()` for exception safety.
+ *
+ * @return Process exit code: `0` on success, `1` on usage errors, `2` on
+ *         runtime errors (unwritable files, etc.).
+ */
+int run(int argc, char *argv[]) {
+  std::ios_base::sync_with_stdio(false);
+
+  popc::detail::planted_partition_options opts;
+  std::size_t num_instances = 1000;
+  char const *output_file = nullptr;
+  char const *labels_file = nullptr;
+  output_format format = output_format::tsv;
+  char delimiter = '\t';
+  std::size_t num_threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+  static option const long_options[] = {
+      {.name = "instances", .has_arg = required_argument, .flag = nullptr, .val = 'n'},
+      {.name = "attributes", .has_arg = required_argument, .flag = nullptr, .val = 'f'},
+      {.name = "clusters", .has_arg = required_argument, .flag = nullptr, .val = 'k'},
+      {.name = "density", .has_arg = required_argument, .flag = nullptr, .val = 'd'},
+      {.name = "p-in", .has_arg = required_argument, .flag = nullptr, .val = 'i'},
+      {.name = "p-out", .has_arg = required_argument, .flag = nullptr, .val = 'u'},
+      {.name = "noise", .has_arg = required_argument, .flag = nullptr, .val = 'e'},
+      {.name = "seed", .has_arg = required_argument, .flag = nullptr, .val = 's'},
+      {.name = "output", .has_arg = required_argument, .flag = nullptr, .val = 'o'},
+      {.name = "labels", .has_arg = required_argument, .flag = nullptr, .val = 'l'},
+      {.name = "format", .has_arg = required_argument, .flag = nullptr, .val = 'F'},
+      {.name = "delimiter", .has_arg = required_argument, .flag = nullptr, .val = 't'},
+      {.name = "threads", .has_arg = required_argument, .flag = nullptr, .val = 'j'},
+      {.name = "help", .has_arg = no_argument, .flag = nullptr, .val = 'h'},
+      {.name = "version", .has_arg = no_argument, .flag = nullptr, .val = 'V'},
+      {.name = nullptr, .has_arg = 0, .flag = nullptr, .val = 0},
+  };
+
+  while (true) {
+    int option_index = 0;
+    int const c =
+        getopt_long(argc, argv, "n:f:k:d:i:u:e:s:o:l:F:t:j:hV", long_options, &option_index);
+    if (c == -1) {
+      break;
+    }
+    std::size_t seed = 0;
+    switch (c) {
+    case 'n':
+      if (!parse_size(optarg, num_instances)) {
+        std::cerr << argv[0] << ": -n, --instances=N must be a non-negative integer\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 'f':
+      if (!parse_size(optarg, opts.num_attributes) || opts.num_attributes == 0) {
+        std::cerr << argv[0] << ": -f, --attributes=F must be a positive integer\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 'k':
+      if (!parse_size(optarg, opts.num_clusters) || opts.num_clusters == 0) {
+        std::cerr << argv[0] << ": -k, --clusters=K must be a positive integer\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 'd':
+      if (!parse_probability(optarg, opts.density)) {
+        std::cerr << argv[0] << ": -d, --density=DENSITY must be a number in [0, 1]\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 'i':
+      if (!parse_probability(optarg, opts.p_in)) {
+        std::cerr << argv[0] << ": -i, --p-in=P_IN must be a number in [0, 1]\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 'u':
+      if (!parse_probability(optarg, opts.p_out)) {
+        std::cerr << argv[0] << ": -u, --p-out=P_OUT must be a number in [0, 1]\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 'e':
+      if (!parse_probability(optarg, opts.noise)) {
+        std::cerr << argv[0] << ": -e, --noise=NOISE must be a number in [0, 1]\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 's':
+      if (!parse_size(optarg, seed)) {
+        std::cerr << argv[0] << ": -s, --seed=SEED must be a non-negative integer\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      opts.seed = seed;
+      break;
+    case 'o':
+      output_file = optarg;
+      break;
+    case 'l':
+      labels_file = optarg;
+      break;
+    case 'F':
+      if (std::strcmp(optarg, "tsv") == 0) {
+        format = output_format::tsv;
+      } else if (std::strcmp(optarg, "binary") == 0) {
+        format = output_format::binary;
+      } else {
+        std::cerr << argv[0] << ": -F, --format=FORMAT must be one of {tsv,binary}\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      break;
+    case 't':
+      if (std::strcmp(optarg, "\\t") == 0) {
+        delimiter = '\t';
+      } else if (std::strlen(optarg) != 1 || optarg[0] == '\n') {
+        std::cerr << argv[0] << ": -t, --delimiter=CHAR must be a single character\n";
+        return 1;
+      } else {
+        delimiter = optarg[0];
+      }
+      break;
+    case 'j':
+      if (!parse_size(optarg, num_threads)) {
+        std::cerr << argv[0] << ": -j, --threads=N must be a non-negative integer\n";
+        short_usage(argv[0], synopsis);
+        return 1;
+      }
+      if (num_threads == 0) {
+        num_threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+      }
+      break;
+    case 'h':
+      usage(argv[0]);
+      return 0;
+    case 'V':
+      std::cout << "popc-gen v" << POPC_VERSION << "\n";
+      return 0;
+    default:
+      short_usage(argv[0], synopsis);
+      return 1;
+    }
+  }
+  if (optind != argc) {
+    std::cerr << argv[0] << ": unexpected argument: " << argv[optind] << "\n";
+    short_usage(argv[0], synopsis);
+    return 1;
+  }
+  if (format == output_format::binary && output_file == nullptr) {
+    std::cerr << argv[0] << ": -F binary requires -o, --output=FILE\n";
+    short_usage(argv[0], synopsis);
+    return 1;
+  }
+
+  std::ofstream file_out;
+  if (output_file != nullptr) {
+    file_out.open(output_file, std::ios::binary);
+    if (!file_out.is_open()) {
+      std::cerr << argv[0] << ": cannot open output file: " << output_file << "\n";
+      return 2;
+    }
+  }
+  std::ofstream labels_out;
+  if (labels_file != nullptr) {
+    labels_out.open(labels_file);
+    if (!labels_out.is_open()) {
+      std::cerr << argv[0] << ": cannot open labels file: " << labels_file << "\n";
+      return 2;
+    }
+  }
+  std::ostream &out = output_file != nullptr ? file_out : std::cout;
+
+  popc::detail::planted_partition const model{opts};
+  generator const gen{model, format, delimiter, labels_file != nullptr};
+
+  popc::detail::binary_header header{};
+  popc::detail::binary_layout layout{};
+  std::vector<std::uint64_t> positive_counts;
+  if (format == output_format::binary) {
+    layout = start_binary(out, header, num_instances, model.num_attributes(),
+                          model.words_per_instance());
+    positive_counts.assign(model.num_attributes(), 0);
+  } else {
+    for (std::size_t j = 0; j < model.num_attributes(); ++j) {
+      out << "attr" << j + 1 << (j + 1 == model.num_attributes() ? '\n' : delimiter);
+    }
+  }
+
+  // Each round generates one chunk per task on the pool while the
+  // previous round's chunks are written out, so generation overlaps I/O.
+  popc::detail::thread_pool pool{num_threads};
+  std::size_t const rows_per_task = std::max<std::size_t>(task_bytes / gen.row_bytes(), 1);
+  std::size_t const tasks = pool.size();
+  std::array<std::vector<chunk>, 2> rounds{std::vector<chunk>(tasks), std::vector<chunk>(tasks)};
+  std::future<void> pending;
+  std::size_t current = 0;
+  for (std::size_t first = 0; first < num_instances; first += tasks * rows_per_task) {
+    auto &chunks = rounds[current];
+    std::size_t const rows = std::min(num_instances - first, tasks * rows_per_task);
+    pool.for_each(tasks, [&](std::size_t t) {
+      std::size_t const begin = std::min(t * rows_per_task, rows);
+      std::size_t const end = std::min(begin + rows_per_task, rows);
+      gen.fill(first + begin, end - begin, chunks[t]);
+    });
+    if (pending.valid()) {
+      pending.get();
+    }
+    pending = std::async(std::launch::async, [&, &round = chunks] {
+      for (auto const &c : round) {
+        out.write(c.data.data(), static_cast<std::streamsize>(c.data.size()));
+        labels_out.write(c.labels.data(), static_cast<std::streamsize>(c.labels.size()));
+        for (std::size_t j = 0; j < c.positive_counts.size(); ++j) {
+          positive_counts[j] += c.positive_counts[j];
+        }
+      }
+    });
+    current ^= 1U;
+  }
+  if (pending.valid()) {
+    pending.get();
+  }
+  if (format == output_format::binary) {
+    finish_binary(out, header, layout, positive_counts);
+  }
+
+  out.flush();
+  if (!out) {
+    std::cerr << argv[0] << ": error writing output\n";
+    return 2;
+  }
+  if (labels_file != nullptr && !labels_out.flush()) {
+    std::cerr << argv[0] << ": error writing labels file: " << labels_file << "\n";
+    return 2;
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  try {
+    return run(argc, argv);
+  } catch (std::exception const &e) {
+    std::cerr << argv[0] << ": " << e.what() << "\n";
+    return 2;
+  } catch (...) {
+    std::cerr << argv[0] << ": unknown error\n";
+    return 2;
+  }
+}
@@ -0,0 +1,80 @@
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <popc/detail/approx_power.hpp>
+
+using popc::detail::approx_pow;
+
+namespace {
+
+// Bases spread over the probabilities POPC raises, from 2^-40 to just
+// below one, checked against a long double reference.
+template <typename fptype> void check_error_bound(fptype power) {
+  std::mt19937_64 rng{7};
+  std::uniform_real_distribution<double> log2_base{-40.0, 0.0};
+  for (int i = 0; i < 20000; ++i) {
+    auto const base = static_cast<fptype>(std::exp2(log2_base(rng)));
+    long double const exact = std::pow(static_cast<long double>(base),
+                                       static_cast<long double>(power));
+    if (exact < static_cast<long double>(std::numeric_limits<fptype>::min())) {
+      continue;
+    }
+    double const y = std::abs(static_cast<double>(power) * std::log2(static_cast<double>(base)));
+    double const bound = (2 * y + 4 * static_cast<double>(power) + 8) *
+                         static_cast<double>(std::numeric_limits<fptype>::epsilon());
+    auto const error = static_cast<double>(
+        std::abs((static_cast<long double>(approx_pow(base, power)) - exact) / exact));
+    INFO("power = " << power << ", base = " << base);
+    REQUIRE(error <= bound);
+  }
+}
+
+using row_kernel = void (*)(double *, std::size_t, double, double, double);
+
+void check_row_kernel(row_kernel kernel) {
+  for (std::size_t length = 0; length < 40; ++length) {
+    std::vector<double> expected(length);
+    std::vector<double> actual(length);
+    double const denom = 37.5 * static_cast<double>(length) + 11;
+    popc::detail::approx_power_row_scalar(expected.data(), length, 37.5, denom, 3.5);
+    kernel(actual.data(), length, 37.5, denom, 3.5);
+    INFO("length = " << length);
+    CHECK(actual == expected);
+  }
+}
+
+} // namespace
+
+TEMPLATE_TEST_CASE("approx_pow: stays within its documented relative error", "[approx_power]",
+                   float, double) {
+  for (auto const power : {0.5, 1.0, 3.5, 10.0, 10.5, 40.0}) {
+    check_error_bound(static_cast<TestType>(power));
+  }
+}
+
+TEMPLATE_TEST_CASE("approx_pow: exact at the ends of the unit interval", "[approx_power]", float,
+                   double) {
+  auto const power = static_cast<TestType>(3.5);
+  CHECK(approx_pow(static_cast<TestType>(1), power) == static_cast<TestType>(1));
+  CHECK(approx_pow(static_cast<TestType>(0.25), static_cast<TestType>(2)) ==
+        static_cast<TestType>(0.0625));
+  // Far below the smallest normal number the result is clamped near it.
+  auto const tiny = approx_pow(static_cast<TestType>(1e-30), static_cast<TestType>(64));
+  CHECK(tiny > 0);
+  CHECK(tiny < 2 * std::numeric_limits<TestType>::min());
+}
+
+TEST_CASE("approx_pow: the selected row kernel matches scalar bit for bit", "[approx_power]") {
+  check_row_kernel(popc::detail::approx_power_row<double>);
+#ifdef POPC_APPROX_POWER_X86
+  if (__builtin_cpu_supports("avx2")) {
+    check_row_kernel(popc::detail::approx_power_row_avx2);
+  }
+#endif
+}
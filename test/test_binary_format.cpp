@@ -0,0 +1,176 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <popc/dataset.hpp>
+#include <popc/detail/binary_format.hpp>
+
+using popc::detail::binary_header;
+using popc::detail::compute_binary_layout;
+
+namespace {
+
+// Serialize `ds` and write the bytes to a fresh file in the temp directory.
+std::filesystem::path write_binary_temp(std::string const &name, popc::dataset const &ds,
+                                        bool include_index) {
+  auto const path = std::filesystem::temp_directory_path() / name;
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  ds.write_binary(out, include_index);
+  return path;
+}
+
+std::filesystem::path write_bytes_temp(std::string const &name, std::string const &bytes) {
+  auto const path = std::filesystem::temp_directory_path() / name;
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  out << bytes;
+  return path;
+}
+
+void check_same(popc::dataset const &a, popc::dataset const &b) {
+  REQUIRE(a.num_instances() == b.num_instances());
+  REQUIRE(a.num_attributes() == b.num_attributes());
+  for (std::size_t j = 0; j < a.num_attributes(); ++j) {
+    CHECK(a.attribute_name(j) == b.attribute_name(j));
+    CHECK(a.positive_count(j) == b.positive_count(j));
+  }
+  for (std::size_t i = 0; i < a.num_instances(); ++i) {
+    auto const wa = a.words(i);
+    auto const wb = b.words(i);
+    CHECK(std::vector<std::uint64_t>(wa.begin(), wa.end()) ==
+          std::vector<std::uint64_t>(wb.begin(), wb.end()));
+    auto const pa = a.positive_attributes(i);
+    auto const pb = b.positive_attributes(i);
+    CHECK(std::vector<popc::dataset::index_type>(pa.begin(), pa.end()) ==
+          std::vector<popc::dataset::index_type>(pb.begin(), pb.end()));
+  }
+}
+
+} // namespace
+
+TEST_CASE("binary_format: sections are 8-byte aligned and sized from the header",
+          "[binary_format]") {
+  binary_header header{};
+  header.num_instances = 3;
+  header.num_attributes = 70;
+  header.words_per_instance = 2;
+  header.num_positive = 5;
+  header.names_bytes = 13;
+  header.flags = popc::detail::binary_flag_index;
+  auto const layout = compute_binary_layout(header);
+  REQUIRE(layout.has_value());
+  CHECK(layout->name_offsets == 64);
+  CHECK(layout->names == 64 + 71 * 8);
+  CHECK(layout->positive_counts == layout->names + 16);
+  CHECK(layout->words == layout->positive_counts + 70 * 8);
+  CHECK(layout->row_offsets == layout->words + 6 * 8);
+  CHECK(layout->positive_attributes == layout->row_offsets + 4 * 8);
+  CHECK(layout->total == layout->positive_attributes + 5 * 4);
+
+  header.flags = 0;
+  auto const unindexed = compute_binary_layout(header);
+  REQUIRE(unindexed.has_value());
+  CHECK(unindexed->total == layout->row_offsets);
+}
+
+TEST_CASE("binary_format: overflowing headers are rejected", "[binary_format]") {
+  binary_header header{};
+  header.num_instances = std::numeric_limits<std::uint64_t>::max() / 2;
+  header.words_per_instance = 4;
+  CHECK_FALSE(compute_binary_layout(header).has_value());
+  header = binary_header{};
+  header.names_bytes = std::numeric_limits<std::uint64_t>::max() - 8;
+  CHECK_FALSE(compute_binary_layout(header).has_value());
+}
+
+TEST_CASE("binary_format: datasets round-trip with and without the index", "[binary_format]") {
+  std::string text{"first\tsecond\tthird-name"};
+  for (int j = 3; j < 130; ++j) {
+    text += "\tc" + std::to_string(j);
+  }
+  text += '\n';
+  for (int i = 0; i < 9; ++i) {
+    for (int j = 0; j < 130; ++j) {
+      text += ((i * 7 + j) % 5 == 0) ? '1' : '0';
+      text += j == 129 ? '\n' : '\t';
+    }
+  }
+  popc::dataset const parsed{std::string_view{text}};
+
+  for (bool const include_index : {true, false}) {
+    INFO("include_index = " << include_index);
+    auto const path = write_binary_temp("popc_test_binary_format.bin", parsed, include_index);
+    popc::dataset const loaded{popc::binary_format, path};
+    check_same(parsed, loaded);
+
+    // Copies share the mapping and stay valid after the original is gone.
+    std::optional<popc::dataset> original{std::in_place, popc::binary_format, path};
+    popc::dataset const copy = *original;
+    original.reset();
+    check_same(parsed, copy);
+
+    std::ostringstream out;
+    out << loaded;
+    CHECK(out.str() == text);
+    std::filesystem::remove(path);
+  }
+}
+
+TEST_CASE("binary_format: header-only and empty datasets round-trip", "[binary_format]") {
+  popc::dataset const header_only{std::string_view{"a\tb\n"}};
+  auto path = write_binary_temp("popc_test_binary_format_header.bin", header_only, true);
+  popc::dataset const loaded{popc::binary_format, path};
+  CHECK(loaded.num_instances() == 0);
+  CHECK(loaded.num_attributes() == 2);
+  CHECK(loaded.positive_count(1) == 0);
+  std::filesystem::remove(path);
+
+  path = write_binary_temp("popc_test_binary_format_empty.bin", popc::dataset{}, false);
+  popc::dataset const empty{popc::binary_format, path};
+  CHECK(empty.num_instances() == 0);
+  CHECK(empty.num_attributes() == 0);
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("binary_format: malformed files are rejected", "[binary_format][error]") {
+  popc::dataset const ds{std::string_view{"a\tb\n1\t0\n0\t1\n"}};
+  std::ostringstream out;
+  ds.write_binary(out);
+  std::string const bytes = out.str();
+  CHECK(popc::dataset::is_binary(bytes));
+  CHECK_FALSE(popc::dataset::is_binary("a\tb\n1\t0\n"));
+
+  auto const rejects = [](std::string const &name, std::string const &contents) {
+    auto const path = write_bytes_temp(name, contents);
+    bool threw = false;
+    try {
+      popc::dataset const loaded{popc::binary_format, path};
+    } catch (std::runtime_error const &) {
+      threw = true;
+    }
+    std::filesystem::remove(path);
+    return threw;
+  };
+  CHECK(rejects("popc_test_binary_text.bin", "a\tb\n1\t0\n"));
+  CHECK(rejects("popc_test_binary_truncated.bin", bytes.substr(0, bytes.size() - 4)));
+  CHECK(rejects("popc_test_binary_trailing.bin", bytes + "x"));
+  std::string wrong_version = bytes;
+  wrong_version[12] = 9;
+  CHECK(rejects("popc_test_binary_version.bin", wrong_version));
+  std::string wrong_order = bytes;
+  std::swap(wrong_order[8], wrong_order[11]);
+  CHECK(rejects("popc_test_binary_order.bin", wrong_order));
+
+  // The text parsers refuse binary input instead of misreading it.
+  CHECK_THROWS_AS(popc::dataset{std::string_view{bytes}}, std::runtime_error);
+  std::istringstream in{bytes};
+  CHECK_THROWS_AS(popc::dataset{in}, std::runtime_error);
+}
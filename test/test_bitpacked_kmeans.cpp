@@ -1,5 +1,7 @@
 #include <bit>
+#include <cstddef>
 #include <cstdint>
+#include <random>
 #include <set>
 #include <sstream>
 #include <vector>
@@ -204,3 +206,130 @@ TEST_CASE("bitpacked_kmodes_seed: empty dataset returns empty assignment", "[kmo
   auto labels = bitpacked_kmodes_seed(bp, 4, 16, 0ULL);
   CHECK(labels.empty());
 }
+
+namespace {
+
+/**
+ * @brief 600 instances drawn around 8 prototypes over 150 attributes (3 words),
+ * so Lloyd's iteration runs several rounds with uneven cluster sizes.
+ */
+popc::dataset prototype_data() {
+  constexpr std::size_t n = 600;
+  constexpr std::size_t f = 150;
+  std::mt19937_64 rng{7};
+  std::bernoulli_distribution bit{0.3};
+  std::bernoulli_distribution keep{0.85};
+  std::vector<bool> prototypes(8 * f);
+  for (std::size_t j = 0; j < prototypes.size(); ++j) {
+    prototypes[j] = bit(rng);
+  }
+  std::vector<bool> values(n * f);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < f; ++j) {
+      values[i * f + j] = keep(rng) ? static_cast<bool>(prototypes[(i % 8) * f + j]) : bit(rng);
+    }
+  }
+  return popc::dataset{values, n, f};
+}
+
+/**
+ * @brief Plain Lloyd's iteration: every centroid scanned for every instance,
+ * with the same initial draw and tie-breaking as bitpacked_kmodes_seed().
+ */
+std::vector<std::size_t> reference_kmodes(popc::dataset const &ds, std::size_t k,
+                                          std::size_t max_iterations, std::uint64_t seed) {
+  std::size_t const n = ds.num_instances();
+  std::size_t const f = ds.num_attributes();
+  std::size_t const wpi = ds.words_per_instance();
+  std::mt19937_64 rng{seed};
+  std::uniform_int_distribution<std::size_t> dist{0, k - 1};
+  std::vector<std::size_t> assignments(n);
+  for (auto &a : assignments) {
+    a = dist(rng);
+  }
+  for (std::size_t iter = 0; iter < max_iterations; ++iter) {
+    std::vector<std::uint64_t> centroids(k * wpi);
+    std::vector<std::size_t> sizes(k);
+    std::vector<std::size_t> counts(k * f);
+    for (std::size_t i = 0; i < n; ++i) {
+      ++sizes[assignments[i]];
+      for (std::size_t j = 0; j < f; ++j) {
+        if (ds(i, j)) {
+          ++counts[assignments[i] * f + j];
+        }
+      }
+    }
+    for (std::size_t c = 0; c < k; ++c) {
+      for (std::size_t j = 0; j < f; ++j) {
+        if (2 * counts[c * f + j] > sizes[c]) {
+          centroids[c * wpi + j / 64] |= std::uint64_t{1} << (j % 64);
+        }
+      }
+    }
+    bool changed = false;
+    for (std::size_t i = 0; i < n; ++i) {
+      std::size_t best_c = assignments[i];
+      std::size_t best_d = f + 1;
+      for (std::size_t c = 0; c < k; ++c) {
+        if (sizes[c] == 0) {
+          continue;
+        }
+        std::size_t const d = hamming_distance(ds.words(i), {centroids.data() + c * wpi, wpi});
+        if (d < best_d) {
+          best_d = d;
+          best_c = c;
+        }
+      }
+      changed = changed || best_c != assignments[i];
+      assignments[i] = best_c;
+    }
+    if (!changed) {
+      break;
+    }
+  }
+  return assignments;
+}
+
+} // namespace
+
+TEST_CASE("bitpacked_kmodes_seed: thread count does not change the assignments", "[kmodes]") {
+  popc::dataset const ds = prototype_data();
+  bitpacked_dataset const bp{ds};
+  std::size_t const n = ds.num_instances();
+
+  for (std::size_t const k : {std::size_t{3}, std::size_t{40}, n / 2}) {
+    auto const serial = bitpacked_kmodes_seed(bp, k, 32, 99ULL);
+    for (std::size_t const threads :
+         {std::size_t{0}, std::size_t{2}, std::size_t{3}, std::size_t{8}}) {
+      CHECK(bitpacked_kmodes_seed(bp, k, 32, 99ULL, threads) == serial);
+    }
+  }
+  CHECK(bitpacked_kmodes_seed(ds, 40, 32, 99ULL, 4) == bitpacked_kmodes_seed(bp, 40, 32, 99ULL));
+}
+
+TEST_CASE("bitpacked_kmodes_seed: bounds and the centroid index keep the assignments exact",
+          "[kmodes]") {
+  popc::dataset const ds = prototype_data();
+  bitpacked_dataset const bp{ds};
+  std::size_t const n = ds.num_instances();
+
+  // Below and above min_indexed_clusters, so both search paths are covered.
+  // At k = 20 clusters start near max_recounted_cluster_size members and
+  // cross it both ways as they merge and drain.
+  for (std::size_t const k :
+       {std::size_t{8}, std::size_t{20}, std::size_t{40}, std::size_t{100}, n / 2}) {
+    popc::detail::kmodes_stats stats;
+    auto const labels = bitpacked_kmodes_seed(bp, k, 32, 5ULL, 1, &stats);
+    CHECK(labels == reference_kmodes(ds, k, 32, 5ULL));
+
+    CHECK(stats.iterations >= 1);
+    CHECK(stats.iterations <= 32);
+    CHECK(stats.assignments == n * stats.iterations);
+    CHECK(stats.bound_skipped + stats.tightened_skipped + stats.searched == stats.assignments);
+    // The first iteration has no bounds and searches for every instance.
+    CHECK(stats.searched >= n);
+    if (stats.iterations > 2) {
+      CHECK(stats.bound_skipped + stats.tightened_skipped > 0);
+    }
+  }
+}
@@ -1,6 +1,9 @@
+#include <cstdint>
+#include <random>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <catch2/catch_test_macros.hpp>
@@ -141,3 +144,207 @@ TEST_CASE("dataset: positive_counts aggregate across instances", "[dataset]") {
   CHECK(ds.positive_count(1) == 2);
   CHECK(ds.positive_count(2) == 3);
 }
+
+TEST_CASE("dataset: positive_attributes lists set columns in order", "[dataset]") {
+  std::istringstream in{"a\tb\tc\td\n1\t0\t1\t1\n0\t0\t0\t0\n0\t1\t0\t0\n"};
+  popc::dataset ds{in};
+
+  using index_type = popc::dataset::index_type;
+  auto const row0 = ds.positive_attributes(0);
+  CHECK(std::vector<index_type>(row0.begin(), row0.end()) == std::vector<index_type>{0, 2, 3});
+  CHECK(ds.positive_attributes(1).empty());
+  auto const row2 = ds.positive_attributes(2);
+  CHECK(std::vector<index_type>(row2.begin(), row2.end()) == std::vector<index_type>{1});
+
+  // The data-vector constructor builds the same index.
+  std::vector<bool> data{true, false, true, true, false, false, false, false, false, true, false,
+                         false};
+  popc::dataset ds2{data, 3, 4};
+  for (std::size_t i = 0; i < ds.num_instances(); ++i) {
+    auto const a = ds.positive_attributes(i);
+    auto const b = ds2.positive_attributes(i);
+    CHECK(std::vector<index_type>(a.begin(), a.end()) ==
+          std::vector<index_type>(b.begin(), b.end()));
+  }
+}
+
+TEST_CASE("dataset: words expose the bitpacked row layout", "[dataset]") {
+  // 70 attributes span two words; bits 0, 3, 64 and 69 are set in row 0.
+  std::vector<bool> data(2 * 70, false);
+  data[0] = data[3] = data[64] = data[69] = true;
+  data[70 + 1] = true;
+  popc::dataset ds{data, 2, 70};
+
+  REQUIRE(ds.words_per_instance() == 2);
+  auto const row0 = ds.words(0);
+  CHECK(row0[0] == 0b1001ULL);
+  CHECK(row0[1] == 0b100001ULL);
+  auto const row1 = ds.words(1);
+  CHECK(row1[0] == 0b10ULL);
+  // Padding bits past attribute 69 stay zero.
+  CHECK(row1[1] == 0ULL);
+}
+
+TEST_CASE("dataset: parser rejects rows with extra columns", "[dataset][error]") {
+  std::istringstream in{"a\tb\n1\t0\t1\n"};
+  CHECK_THROWS_AS(popc::dataset{in}, std::runtime_error);
+}
+
+TEST_CASE("dataset: stream insertion round-trips through the parser", "[dataset]") {
+  std::istringstream in{"a\tb\tc\n1\t0\t1\n0\t1\t0\n1\t1\t1\n"};
+  popc::dataset ds{in};
+  std::ostringstream out;
+  out << ds;
+  CHECK(out.str() == "a\tb\tc\n1\t0\t1\n0\t1\t0\n1\t1\t1\n");
+}
+
+TEST_CASE("dataset: buffer constructor matches the stream constructor", "[dataset]") {
+  std::string const text{"a\tb\tc\n1\t0\t1\n0\t1\t0\n1\t1\t1\n"};
+  std::istringstream in{text};
+  popc::dataset const from_stream{in};
+  popc::dataset const from_buffer{std::string_view{text}};
+
+  REQUIRE(from_buffer.num_instances() == from_stream.num_instances());
+  REQUIRE(from_buffer.num_attributes() == from_stream.num_attributes());
+  for (std::size_t j = 0; j < from_stream.num_attributes(); ++j) {
+    CHECK(from_buffer.attribute_name(j) == from_stream.attribute_name(j));
+    CHECK(from_buffer.positive_count(j) == from_stream.positive_count(j));
+  }
+  for (std::size_t i = 0; i < from_stream.num_instances(); ++i) {
+    auto const a = from_buffer.words(i);
+    auto const b = from_stream.words(i);
+    CHECK(std::vector<std::uint64_t>(a.begin(), a.end()) ==
+          std::vector<std::uint64_t>(b.begin(), b.end()));
+    auto const pa = from_buffer.positive_attributes(i);
+    auto const pb = from_stream.positive_attributes(i);
+    CHECK(std::vector<popc::dataset::index_type>(pa.begin(), pa.end()) ==
+          std::vector<popc::dataset::index_type>(pb.begin(), pb.end()));
+  }
+}
+
+TEST_CASE("dataset: buffer constructor accepts custom delimiter and empty input", "[dataset]") {
+  popc::dataset const ds{std::string_view{"x,y\n1,1\n0,0\n"}, ','};
+  REQUIRE(ds.num_instances() == 2);
+  CHECK(ds(0, 1) == true);
+  CHECK(ds(1, 0) == false);
+
+  popc::dataset const empty{std::string_view{}};
+  CHECK(empty.num_instances() == 0);
+  CHECK(empty.num_attributes() == 0);
+}
+
+TEST_CASE("dataset: buffer and stream constructors report identical errors",
+          "[dataset][error]") {
+  for (std::string const text : {"a\tb\n1\t2\n", "a\tb\tc\n1\t0\n0\t1\t0\n", "a\tb\n\t0\n",
+                                 "a\tb\n1\t0\n0\t1\n1\t1\nbad\t0\n", "a\tb\n1\t0\t1\n",
+                                 "a\tb\n1\t0\n1\n", "a\tb\n1\t0\n1\t1"}) {
+    std::string stream_error;
+    std::string buffer_error;
+    try {
+      std::istringstream in{text};
+      popc::dataset const ds{in};
+    } catch (std::runtime_error const &e) {
+      stream_error = e.what();
+    }
+    try {
+      popc::dataset const ds{std::string_view{text}};
+    } catch (std::runtime_error const &e) {
+      buffer_error = e.what();
+    }
+    INFO(text);
+    REQUIRE_FALSE(buffer_error.empty());
+    CHECK(buffer_error == stream_error);
+  }
+}
+
+TEST_CASE("dataset: wide rows decode identically on the vector and byte-wise paths",
+          "[dataset]") {
+  // 100 attributes: three full 32-attribute chunks plus a 4-attribute tail.
+  // Row 1 is well formed and goes through the vector decoder; row 2 has a
+  // bad value in the final chunk and must be reported with its column.
+  std::string text;
+  for (int j = 0; j < 100; ++j) {
+    if (j != 0) {
+      text += '\t';
+    }
+    text += 'f';
+    text += std::to_string(j);
+  }
+  text += '\n';
+  std::vector<bool> expected;
+  for (int j = 0; j < 100; ++j) {
+    bool const bit = j % 3 == 0 || j == 99;
+    expected.push_back(bit);
+    text += (bit ? '1' : '0');
+    text += (j == 99 ? '\n' : '\t');
+  }
+  popc::dataset const ds{std::string_view{text}};
+  REQUIRE(ds.num_instances() == 1);
+  CHECK(std::vector<bool>(ds.cbegin(0), ds.cend(0)) == expected);
+  CHECK(ds.positive_attributes(0).size() == 34);
+
+  std::string bad = text;
+  bad += text.substr(text.find('\n') + 1);
+  bad[bad.size() - 2 * 100 + 2 * 70] = 'x';
+  try {
+    popc::dataset const broken{std::string_view{bad}};
+    FAIL("expected parser to throw on malformed row");
+  } catch (std::runtime_error const &e) {
+    std::string const msg{e.what()};
+    CHECK(msg.find("line 3 column 71") != std::string::npos);
+  }
+}
+
+TEST_CASE("dataset: multi-threaded buffer parse matches the serial parse", "[dataset]") {
+  // About 4 MiB of rows, enough to be split into several 1 MiB chunks.
+  constexpr std::size_t num_attributes = 200;
+  constexpr std::size_t num_rows = 10000;
+  std::mt19937_64 rng{7};
+  std::string text;
+  for (std::size_t j = 0; j < num_attributes; ++j) {
+    text += (j == 0 ? "a" : "\ta") + std::to_string(j);
+  }
+  text += '\n';
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    for (std::size_t j = 0; j < num_attributes; ++j) {
+      text += (rng() % 7 == 0) ? '1' : '0';
+      text += j + 1 == num_attributes ? '\n' : '\t';
+    }
+  }
+
+  popc::dataset const serial{std::string_view{text}};
+  popc::dataset const parallel{std::string_view{text}, '\t', 4};
+  REQUIRE(parallel.num_instances() == num_rows);
+  for (std::size_t j = 0; j < num_attributes; ++j) {
+    CHECK(parallel.positive_count(j) == serial.positive_count(j));
+  }
+  for (std::size_t i = 0; i < num_rows; ++i) {
+    auto const a = parallel.words(i);
+    auto const b = serial.words(i);
+    REQUIRE(std::vector<std::uint64_t>(a.begin(), a.end()) ==
+            std::vector<std::uint64_t>(b.begin(), b.end()));
+    auto const pa = parallel.positive_attributes(i);
+    auto const pb = serial.positive_attributes(i);
+    REQUIRE(std::vector<popc::dataset::index_type>(pa.begin(), pa.end()) ==
+            std::vector<popc::dataset::index_type>(pb.begin(), pb.end()));
+  }
+
+  // Errors in a late chunk, and in two chunks at once, keep the line
+  // number of the first bad row in the input.
+  auto const error_of = [](std::string const &input, std::size_t threads) {
+    try {
+      popc::dataset const ds{std::string_view{input}, '\t', threads};
+    } catch (std::runtime_error const &e) {
+      return std::string{e.what()};
+    }
+    return std::string{};
+  };
+  std::size_t const header_bytes = text.find('\n') + 1;
+  std::string bad = text;
+  bad[header_bytes + 9000 * 2 * num_attributes + 10] = 'x';
+  CHECK(error_of(bad, 4) == error_of(bad, 1));
+  CHECK(error_of(bad, 4).find("line 9002 column 6") != std::string::npos);
+  bad[header_bytes + 6000 * 2 * num_attributes + 1] = ',';
+  CHECK(error_of(bad, 4) == error_of(bad, 1));
+  CHECK(error_of(bad, 4).find("line 6002") != std::string::npos);
+}
@@ -0,0 +1,88 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <popc/detail/delta_kernel.hpp>
+
+namespace {
+
+// Accumulators, counts and a table row with irregular values, so that
+// rounding differs between evaluation orders.
+template <typename fptype> struct kernel_input {
+  std::vector<fptype> acc;
+  std::vector<std::uint32_t> counts;
+  std::vector<fptype> row;
+};
+
+template <typename fptype> kernel_input<fptype> make_input(std::size_t n, std::uint64_t seed) {
+  std::mt19937_64 rng{seed};
+  std::uniform_real_distribution<fptype> value{static_cast<fptype>(-1), static_cast<fptype>(1)};
+  kernel_input<fptype> in;
+  in.row.resize(200);
+  for (auto &r : in.row) {
+    r = value(rng) * static_cast<fptype>(1e-3);
+  }
+  for (std::size_t k = 0; k < n; ++k) {
+    in.acc.push_back(value(rng));
+    in.counts.push_back(static_cast<std::uint32_t>(rng() % (in.row.size() - 1)));
+  }
+  return in;
+}
+
+template <typename fptype>
+void check_kernel(popc::detail::accumulate_terms_fn<fptype> kernel) {
+  for (std::size_t n = 0; n < 70; ++n) {
+    auto const in = make_input<fptype>(n, n + 1);
+    auto expected = in.acc;
+    popc::detail::accumulate_terms_scalar(expected.data(), in.counts.data(), n, in.row.data());
+    auto actual = in.acc;
+    kernel(actual.data(), in.counts.data(), n, in.row.data());
+    INFO("n = " << n);
+    CHECK(actual == expected);
+  }
+}
+
+} // namespace
+
+TEMPLATE_TEST_CASE("accumulate_terms: scalar kernel subtracts then adds per candidate",
+                   "[delta_kernel]", float, double) {
+  std::vector<TestType> acc{1, 2, 3};
+  std::vector<std::uint32_t> const counts{0, 2, 1};
+  std::vector<TestType> const row{10, 20, 40, 80};
+  popc::detail::accumulate_terms_scalar(acc.data(), counts.data(), acc.size(), row.data());
+  CHECK(acc == std::vector<TestType>{11, 42, 23});
+}
+
+TEMPLATE_TEST_CASE("accumulate_terms: selected kernel matches scalar bit for bit",
+                   "[delta_kernel]", float, double) {
+  check_kernel<TestType>(popc::detail::select_accumulate_terms<TestType>());
+
+  auto const in = make_input<TestType>(37, 99);
+  auto expected = in.acc;
+  popc::detail::accumulate_terms_scalar(expected.data(), in.counts.data(), in.acc.size(),
+                                        in.row.data());
+  auto actual = in.acc;
+  popc::detail::accumulate_terms(std::span<TestType>{actual},
+                                 std::span<std::uint32_t const>{in.counts},
+                                 std::span<TestType const>{in.row});
+  CHECK(actual == expected);
+}
+
+#ifdef POPC_DELTA_KERNEL_X86
+
+TEMPLATE_TEST_CASE("accumulate_terms: every supported x86 kernel matches scalar",
+                   "[delta_kernel]", float, double) {
+  if (__builtin_cpu_supports("avx2")) {
+    check_kernel<TestType>(popc::detail::accumulate_terms_avx2);
+  }
+  if (__builtin_cpu_supports("avx512f")) {
+    check_kernel<TestType>(popc::detail::accumulate_terms_avx512);
+  }
+}
+
+#endif
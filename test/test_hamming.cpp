@@ -0,0 +1,114 @@
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <popc/detail/hamming.hpp>
+
+namespace {
+
+// Widths around every boundary the kernels branch on: the POPCNT cutoff,
+// whole 256- and 512-bit vectors with and without tails, and one, two and
+// a partial Harley-Seal block of sixteen 256-bit vectors.
+std::vector<std::size_t> widths() {
+  std::vector<std::size_t> out;
+  for (std::size_t words = 0; words <= 20; ++words) {
+    out.push_back(words);
+  }
+  for (std::size_t const words :
+       std::initializer_list<std::size_t>{31, 32, 33, 63, 64, 65, 67, 100, 127, 128, 131, 200}) {
+    out.push_back(words);
+  }
+  return out;
+}
+
+/** @brief `count` random vectors of `words` words, biased so distances vary. */
+std::vector<std::uint64_t> random_words(std::size_t words, std::size_t count,
+                                        std::uint64_t seed) {
+  std::mt19937_64 rng{seed};
+  std::vector<std::uint64_t> out(words * count);
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    switch (rng() % 4) {
+    case 0:
+      out[i] = 0;
+      break;
+    case 1:
+      out[i] = ~std::uint64_t{0};
+      break;
+    default:
+      out[i] = rng();
+    }
+  }
+  return out;
+}
+
+void check_kernels(popc::detail::hamming_distance_fn distance,
+                   popc::detail::hamming_distances_fn distances) {
+  constexpr std::size_t count = 9;
+  for (auto const words : widths()) {
+    auto const query = random_words(words, 1, words + 1);
+    auto const points = random_words(words, count, words + 1000);
+    std::vector<std::size_t> out(count);
+    distances(query.data(), points.data(), words, count, out.data());
+    for (std::size_t c = 0; c < count; ++c) {
+      std::uint64_t const *const point = points.data() + c * words;
+      std::size_t const expected =
+          popc::detail::hamming_distance_scalar(query.data(), point, words);
+      INFO("words = " << words << ", point " << c);
+      CHECK(distance(query.data(), point, words) == expected);
+      CHECK(out[c] == expected);
+    }
+  }
+}
+
+} // namespace
+
+TEST_CASE("hamming_distance: scalar kernel counts differing bits", "[hamming]") {
+  std::vector<std::uint64_t> const a{0x0ULL, 0xF0ULL, ~0x0ULL};
+  std::vector<std::uint64_t> const b{0x1ULL, 0x0FULL, 0x0ULL};
+  CHECK(popc::detail::hamming_distance_scalar(a.data(), b.data(), 0) == 0);
+  CHECK(popc::detail::hamming_distance_scalar(a.data(), b.data(), 1) == 1);
+  CHECK(popc::detail::hamming_distance_scalar(a.data(), b.data(), 3) == 73);
+
+  std::vector<std::size_t> out(2);
+  popc::detail::hamming_distances_scalar(a.data(), b.data(), 1, 2, out.data());
+  CHECK(out == std::vector<std::size_t>{1, 4});
+}
+
+TEST_CASE("hamming_distance: selected kernels match scalar", "[hamming]") {
+  auto const selected = popc::detail::select_hamming_kernels();
+  check_kernels(selected.distance, selected.distances);
+}
+
+TEST_CASE("hamming_distances: one-vs-many wrapper measures every point", "[hamming]") {
+  std::size_t const words = 70;
+  std::size_t const count = 13;
+  auto const query = random_words(words, 1, 5);
+  auto const points = random_words(words, count, 6);
+  std::vector<std::size_t> out(count);
+  popc::detail::hamming_distances(query, points, out);
+  for (std::size_t c = 0; c < count; ++c) {
+    CHECK(out[c] == popc::detail::hamming_distance(
+                        query, std::span{points}.subspan(c * words, words)));
+  }
+
+  // An empty block writes nothing.
+  popc::detail::hamming_distances(query, {}, {});
+}
+
+#ifdef POPC_HAMMING_X86
+
+TEST_CASE("hamming_distance: every supported x86 kernel matches scalar", "[hamming]") {
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+    check_kernels(popc::detail::hamming_distance_avx2, popc::detail::hamming_distances_avx2);
+  }
+  if (__builtin_cpu_supports("avx512vpopcntdq")) {
+    check_kernels(popc::detail::hamming_distance_avx512, popc::detail::hamming_distances_avx512);
+  }
+}
+
+#endif
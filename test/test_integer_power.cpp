@@ -0,0 +1,117 @@
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <popc/detail/integer_power.hpp>
+
+using popc::detail::integer_pow;
+using popc::detail::power_function;
+
+namespace {
+
+// Probabilities of the magnitudes POPC raises, plus a few plain values.
+template <typename fptype> std::vector<fptype> bases() {
+  return {static_cast<fptype>(0),        static_cast<fptype>(1),
+          static_cast<fptype>(0.5),      static_cast<fptype>(1.0 / 3.0),
+          static_cast<fptype>(0.999),    static_cast<fptype>(1.0 / 2001.0),
+          static_cast<fptype>(0.123456), static_cast<fptype>(2)};
+}
+
+template <typename fptype, unsigned... P>
+void check_unrolled(std::integer_sequence<unsigned, P...> /*powers*/) {
+  for (auto const base : bases<fptype>()) {
+    // Exact equality: both overloads must multiply in the same order.
+    CHECK(((integer_pow<P>(base) == integer_pow(base, P)) && ...));
+  }
+}
+
+} // namespace
+
+TEST_CASE("integer_pow: small powers by hand", "[integer_power]") {
+  CHECK(integer_pow(3.0, 0) == 1.0);
+  CHECK(integer_pow(3.0, 1) == 3.0);
+  CHECK(integer_pow(3.0, 2) == 9.0);
+  CHECK(integer_pow(3.0, 5) == 243.0);
+  CHECK(integer_pow(2.0, 10) == 1024.0);
+  CHECK(integer_pow<10>(2.0) == 1024.0);
+  static_assert(integer_pow<7>(2.0) == 128.0);
+}
+
+TEMPLATE_TEST_CASE("integer_pow: compile-time and runtime overloads are bit-identical",
+                   "[integer_power]", float, double) {
+  check_unrolled<TestType>(
+      std::make_integer_sequence<unsigned, popc::detail::max_unrolled_power + 4>{});
+}
+
+TEMPLATE_TEST_CASE("power_function: repeated squaring stays within its error bound of std::pow",
+                   "[integer_power]", float, double) {
+  for (unsigned const power : {2U, 3U, 10U, 17U, 64U}) {
+    power_function<TestType> const raise{static_cast<TestType>(power), true};
+    for (auto const base : bases<TestType>()) {
+      auto const expected = std::pow(base, static_cast<TestType>(power));
+      if (expected < std::numeric_limits<TestType>::min()) {
+        continue; // Subnormal results carry no relative precision.
+      }
+      auto const tolerance =
+          (raise.error_ulps() + 1) * std::numeric_limits<TestType>::epsilon() * expected;
+      INFO("power = " << power << ", base = " << base);
+      CHECK(std::abs(raise(base) - expected) <= tolerance);
+    }
+  }
+}
+
+TEMPLATE_TEST_CASE("power_function: rows match single evaluations bit for bit", "[integer_power]",
+                   float, double) {
+  auto const multiplier = static_cast<TestType>(37.5);
+  auto const denom = static_cast<TestType>(1234);
+  for (auto const &[power, integral] : {std::pair{10.0, true}, std::pair{33.0, true},
+                                       std::pair{0.0, true}, std::pair{3.5, false}}) {
+    power_function<TestType> const raise{static_cast<TestType>(power), integral};
+    std::vector<TestType> row(30);
+    raise.fill(row, multiplier, denom);
+    for (std::size_t c = 0; c < row.size(); ++c) {
+      INFO("power = " << power << ", c = " << c);
+      CHECK(row[c] == raise((static_cast<TestType>(c) * multiplier + 1) / denom));
+    }
+  }
+}
+
+TEST_CASE("power_function: std::pow unless asked for integer powers", "[integer_power]") {
+  power_function<double> const raise{3.5};
+  CHECK_FALSE(raise.integral());
+  CHECK(raise(0.25) == std::pow(0.25, 3.5));
+  CHECK(raise.error_ulps() == 1.0);
+
+  CHECK(power_function<double>{10.0, true}.integral());
+  CHECK(power_function<double>{10.0, true}.error_ulps() == 9.0);
+}
+
+TEST_CASE("power_function: the approximate mode uses approx_pow", "[integer_power]") {
+  power_function<double> const raise{popc::detail::approximate_power, 3.5};
+  CHECK(raise.approximate());
+  CHECK_FALSE(raise.integral());
+  CHECK(raise(0.25) == popc::detail::approx_pow(0.25, 3.5));
+  std::vector<double> row(9);
+  raise.fill(row, 37.5, 400.0);
+  for (std::size_t c = 0; c < row.size(); ++c) {
+    CHECK(row[c] == raise((static_cast<double>(c) * 37.5 + 1) / 400.0));
+  }
+  CHECK_THROWS_AS((power_function<double>{popc::detail::approximate_power, -1.0}),
+                  std::logic_error);
+}
+
+TEST_CASE("power_function: integer powers must be small non-negative integers",
+          "[integer_power]") {
+  CHECK_THROWS_AS((power_function<double>{2.5, true}), std::logic_error);
+  CHECK_THROWS_AS((power_function<double>{-1.0, true}), std::logic_error);
+  CHECK_THROWS_AS((power_function<double>{65.0, true}), std::logic_error);
+  CHECK_THROWS_AS((power_function<double>{std::nan(""), true}), std::logic_error);
+  CHECK_NOTHROW((power_function<double>{64.0, true}));
+  CHECK_NOTHROW((power_function<double>{2.5, false}));
+}
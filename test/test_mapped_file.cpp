@@ -0,0 +1,59 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <popc/dataset.hpp>
+#include <popc/detail/mapped_file.hpp>
+
+using popc::detail::mapped_file;
+
+namespace {
+
+// Write `contents` to a fresh file in the temp directory and return its path.
+std::filesystem::path write_temp(std::string const &name, std::string const &contents) {
+  auto const path = std::filesystem::temp_directory_path() / name;
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  out << contents;
+  return path;
+}
+
+} // namespace
+
+TEST_CASE("mapped_file: exposes the file contents", "[mapped_file]") {
+  auto const path = write_temp("popc_test_mapped_file.tsv", "a\tb\n1\t0\n0\t1\n");
+  mapped_file const file{path.c_str()};
+  CHECK(file.size() == 12);
+  CHECK(file.view() == "a\tb\n1\t0\n0\t1\n");
+
+  popc::dataset const ds{file.view()};
+  CHECK(ds.num_instances() == 2);
+  CHECK(ds(0, 0) == true);
+  CHECK(ds(1, 1) == true);
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("mapped_file: empty file yields an empty view", "[mapped_file]") {
+  auto const path = write_temp("popc_test_mapped_file_empty.tsv", "");
+  mapped_file const file{path.c_str()};
+  CHECK(file.size() == 0);
+  CHECK(file.view().empty());
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("mapped_file: move transfers the mapping", "[mapped_file]") {
+  auto const path = write_temp("popc_test_mapped_file_move.tsv", "x\n1\n");
+  mapped_file a{path.c_str()};
+  mapped_file b{std::move(a)};
+  CHECK(a.view().empty()); // NOLINT(bugprone-use-after-move)
+  CHECK(b.view() == "x\n1\n");
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("mapped_file: missing files and directories are rejected", "[mapped_file][error]") {
+  CHECK_THROWS_AS(mapped_file{"/nonexistent/popc/input.tsv"}, std::system_error);
+  CHECK_THROWS_AS(mapped_file{std::filesystem::temp_directory_path().c_str()}, std::system_error);
+}
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <popc/cluster.hpp>
+#include <popc/dataset.hpp>
+#include <popc/partition.hpp>
+
+namespace {
+
+// Five instances over three attributes.
+popc::dataset make_dataset() {
+  std::istringstream in{"a\tb\tc\n"
+                        "1\t0\t1\n"
+                        "1\t1\t0\n"
+                        "0\t1\t1\n"
+                        "1\t1\t1\n"
+                        "0\t0\t1\n"};
+  return popc::dataset{in};
+}
+
+std::vector<std::size_t> members_of(popc::partition const &part, std::size_t slot) {
+  auto const &m = part.members(slot);
+  return {m.begin(), m.end()};
+}
+
+} // namespace
+
+TEST_CASE("partition: built from labels", "[partition]") {
+  auto const ds = make_dataset();
+  std::vector<std::size_t> const labels{1, 0, 1, 3, 0};
+  popc::partition const part{ds, labels};
+
+  REQUIRE(part.num_attributes() == 3);
+  REQUIRE(part.num_slots() == 4);
+  CHECK(part.num_clusters() == 4);
+  CHECK(members_of(part, 0) == std::vector<std::size_t>{1, 4});
+  CHECK(members_of(part, 1) == std::vector<std::size_t>{0, 2});
+  CHECK(part.empty(2));
+  CHECK(members_of(part, 3) == std::vector<std::size_t>{3});
+
+  CHECK(part.count(0, 0) == 1);
+  CHECK(part.count(0, 1) == 1);
+  CHECK(part.count(0, 2) == 1);
+  CHECK(part.count(1, 0) == 1);
+  CHECK(part.count(1, 1) == 1);
+  CHECK(part.count(1, 2) == 2);
+  CHECK(part.count(2, 2) == 0);
+
+  auto const row = part.attribute_row(2);
+  REQUIRE(row.size() == 4);
+  CHECK(row[0] == 1);
+  CHECK(row[1] == 2);
+  CHECK(row[2] == 0);
+  CHECK(row[3] == 1);
+}
+
+TEST_CASE("partition: rejects a label vector of the wrong size", "[partition]") {
+  auto const ds = make_dataset();
+  std::vector<std::size_t> const labels{0, 0};
+  CHECK_THROWS_AS((popc::partition{ds, labels}), std::logic_error);
+}
+
+TEST_CASE("partition: cluster views mirror the popc::cluster API", "[partition]") {
+  auto const ds = make_dataset();
+  std::vector<std::size_t> const labels{0, 0, 1, 1, 1};
+  popc::partition const part{ds, labels};
+
+  auto const view = part.cluster(1);
+  CHECK(view.slot() == 1);
+  CHECK_FALSE(view.empty());
+  CHECK(view.num_instances() == 3);
+  CHECK(view.attribute_count(0) == 1);
+  CHECK(view.attribute_count(1) == 2);
+  CHECK(view.attribute_count(2) == 3);
+  CHECK(std::vector<std::size_t>(view.begin(), view.end()) == std::vector<std::size_t>{2, 3, 4});
+}
+
+TEST_CASE("partition: round-trips a cluster list in order", "[partition]") {
+  auto const ds = make_dataset();
+  std::list<popc::cluster> clusters;
+  for (auto const &group : {std::vector<std::size_t>{4, 0}, std::vector<std::size_t>{},
+                            std::vector<std::size_t>{2, 1, 3}}) {
+    auto &c = clusters.emplace_back(ds.num_attributes());
+    for (auto const i : group) {
+      c.add_instance(i);
+      for (auto const j : ds.positive_attributes(i)) {
+        c.increment_attribute_count(j);
+      }
+    }
+  }
+
+  popc::partition const part{ds, clusters};
+  REQUIRE(part.num_slots() == 3);
+  CHECK(members_of(part, 0) == std::vector<std::size_t>{4, 0});
+  CHECK(part.empty(1));
+  CHECK(members_of(part, 2) == std::vector<std::size_t>{2, 1, 3});
+
+  auto const back = part.to_clusters();
+  REQUIRE(back.size() == clusters.size());
+  auto it = clusters.begin();
+  for (auto const &c : back) {
+    CHECK(std::vector<std::size_t>(c.begin(), c.end()) ==
+          std::vector<std::size_t>(it->begin(), it->end()));
+    for (std::size_t j = 0; j < ds.num_attributes(); ++j) {
+      CHECK(c.attribute_count(j) == it->attribute_count(j));
+    }
+    ++it;
+  }
+}
+
+TEST_CASE("partition: move appends to the destination and updates counts", "[partition]") {
+  auto const ds = make_dataset();
+  std::vector<std::size_t> const labels{0, 0, 0, 1, 1};
+  popc::partition part{ds, labels};
+
+  part.move(ds, 1, 1);
+  CHECK(part.slot_of(1) == 1);
+  CHECK(members_of(part, 0) == std::vector<std::size_t>{0, 2});
+  CHECK(members_of(part, 1) == std::vector<std::size_t>{3, 4, 1});
+  CHECK(part.members(0).size() == 2);
+  CHECK(part.members(1).size() == 3);
+  CHECK(part.count(0, 0) == 1);
+  CHECK(part.count(0, 1) == 1);
+  CHECK(part.count(1, 0) == 2);
+  CHECK(part.count(1, 1) == 2);
+  CHECK(part.count(1, 2) == 2);
+}
+
+TEST_CASE("partition: members keep their order across head and tail moves", "[partition]") {
+  auto const ds = make_dataset();
+  std::vector<std::size_t> const labels{0, 0, 0, 0, 1};
+  popc::partition part{ds, labels};
+
+  // Visit slot 0 the way popc() does, moving the first, a middle and the
+  // last member out while iterating.
+  std::vector<std::size_t> visited;
+  auto const members = part.members(0);
+  for (auto it = members.begin(); it != members.end();) {
+    auto const instance_num = *it++;
+    visited.push_back(instance_num);
+    if (instance_num != 1) {
+      part.move(ds, instance_num, 1);
+    }
+  }
+  CHECK(visited == std::vector<std::size_t>{0, 1, 2, 3});
+  CHECK(members_of(part, 0) == std::vector<std::size_t>{1});
+  CHECK(members_of(part, 1) == std::vector<std::size_t>{4, 0, 2, 3});
+
+  part.move(ds, 4, 0);
+  CHECK(members_of(part, 0) == std::vector<std::size_t>{1, 4});
+  CHECK(members_of(part, 1) == std::vector<std::size_t>{0, 2, 3});
+
+  part.move(ds, 1, 1);
+  part.move(ds, 4, 1);
+  CHECK(part.empty(0));
+  CHECK(part.members(0).begin() == part.members(0).end());
+  CHECK(members_of(part, 1) == std::vector<std::size_t>{0, 2, 3, 1, 4});
+  CHECK(part.labels() == std::vector<std::size_t>{1, 1, 1, 1, 1});
+}
+
+TEST_CASE("partition: erase defers compaction and compact keeps order", "[partition]") {
+  auto const ds = make_dataset();
+  std::vector<std::size_t> const labels{0, 2, 2, 3, 3};
+  popc::partition part{ds, labels};
+  REQUIRE(part.num_slots() == 4);
+  REQUIRE(part.empty(1));
+
+  part.erase(1);
+  CHECK(part.num_slots() == 4);
+  CHECK(part.num_clusters() == 3);
+  CHECK_FALSE(part.alive(1));
+  CHECK(members_of(part, 2) == std::vector<std::size_t>{1, 2});
+
+  // Labels skip erased slots even before compaction.
+  CHECK(part.labels() == std::vector<std::size_t>{0, 1, 1, 2, 2});
+  CHECK(part.to_clusters().size() == 3);
+
+  part.compact();
+  REQUIRE(part.num_slots() == 3);
+  CHECK(part.num_clusters() == 3);
+  CHECK(part.alive(1));
+  CHECK(members_of(part, 0) == std::vector<std::size_t>{0});
+  CHECK(members_of(part, 1) == std::vector<std::size_t>{1, 2});
+  CHECK(members_of(part, 2) == std::vector<std::size_t>{3, 4});
+  CHECK(part.count(1, 0) == 1);
+  CHECK(part.count(1, 1) == 2);
+  CHECK(part.count(1, 2) == 1);
+  CHECK(part.count(2, 0) == 1);
+  CHECK(part.count(2, 2) == 2);
+  CHECK(part.labels() == std::vector<std::size_t>{0, 1, 1, 2, 2});
+}
+
+TEST_CASE("partition: attribute index follows moves and compaction", "[partition]") {
+  auto const ds = make_dataset();
+  std::vector<std::size_t> const labels{0, 2, 2, 3, 3};
+  popc::partition part{ds, labels};
+  CHECK_FALSE(part.has_attribute_index());
+  part.build_attribute_index();
+  REQUIRE(part.has_attribute_index());
+
+  auto const slots_with = [&part](std::size_t attribute_num) {
+    auto const list = part.clusters_with(attribute_num);
+    std::vector<std::size_t> slots{list.begin(), list.end()};
+    std::sort(slots.begin(), slots.end());
+    return slots;
+  };
+  CHECK(slots_with(0) == std::vector<std::size_t>{0, 2, 3});
+  CHECK(slots_with(1) == std::vector<std::size_t>{2, 3});
+  CHECK(slots_with(2) == std::vector<std::size_t>{0, 2, 3});
+
+  // Instance 1 is the only member of slot 2 with attribute a.
+  part.move(ds, 1, 0);
+  CHECK(slots_with(0) == std::vector<std::size_t>{0, 3});
+  CHECK(slots_with(1) == std::vector<std::size_t>{0, 2, 3});
+  CHECK(slots_with(2) == std::vector<std::size_t>{0, 2, 3});
+  part.move(ds, 2, 0);
+  CHECK(slots_with(0) == std::vector<std::size_t>{0, 3});
+  CHECK(slots_with(1) == std::vector<std::size_t>{0, 3});
+  CHECK(slots_with(2) == std::vector<std::size_t>{0, 3});
+
+  part.erase(1);
+  part.erase(2);
+  part.compact();
+  REQUIRE(part.num_slots() == 2);
+  CHECK(part.has_attribute_index());
+  CHECK(slots_with(0) == std::vector<std::size_t>{0, 1});
+  CHECK(slots_with(1) == std::vector<std::size_t>{0, 1});
+  part.move(ds, 4, 0);
+  CHECK(slots_with(2) == std::vector<std::size_t>{0, 1});
+  part.move(ds, 3, 0);
+  CHECK(slots_with(0) == std::vector<std::size_t>{0});
+  CHECK(slots_with(2) == std::vector<std::size_t>{0});
+}
+
+TEST_CASE("partition: by_size stays ordered across moves and compaction", "[partition]") {
+  auto const ds = make_dataset();
+  std::vector<std::size_t> const labels{0, 2, 2, 3, 3};
+  popc::partition part{ds, labels};
+
+  auto const check_order = [&part] {
+    auto const order = part.by_size();
+    REQUIRE(order.size() == part.num_slots());
+    std::vector<std::size_t> slots{order.begin(), order.end()};
+    for (std::size_t p = 1; p < slots.size(); ++p) {
+      CHECK(part.size(slots[p - 1]) >= part.size(slots[p]));
+    }
+    std::sort(slots.begin(), slots.end());
+    for (std::size_t k = 0; k < slots.size(); ++k) {
+      CHECK(slots[k] == k);
+    }
+  };
+  check_order();
+  CHECK(part.size(1) == 0);
+  CHECK(part.size(2) == 2);
+
+  part.move(ds, 0, 3);
+  check_order();
+  CHECK(part.by_size().front() == 3);
+  part.move(ds, 1, 1);
+  part.move(ds, 2, 1);
+  part.move(ds, 4, 1);
+  check_order();
+  CHECK(part.size(1) == 3);
+  CHECK(part.size(3) == 2);
+
+  part.erase(0);
+  part.erase(2);
+  part.compact();
+  check_order();
+  CHECK(part.by_size().front() == 0);
+  CHECK(part.size(0) == 3);
+  CHECK(part.size(1) == 2);
+}
@@ -0,0 +1,155 @@
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <popc/detail/planted_partition.hpp>
+
+using popc::detail::planted_partition;
+using popc::detail::planted_partition_options;
+
+namespace {
+
+/** @brief Generate rows `[0, n)` of `model`, concatenated. */
+std::vector<std::uint64_t> rows(planted_partition const &model, std::size_t n) {
+  std::vector<std::uint64_t> out(n * model.words_per_instance());
+  for (std::size_t i = 0; i < n; ++i) {
+    (void)model.generate(
+        i, std::span{out.data() + i * model.words_per_instance(), model.words_per_instance()});
+  }
+  return out;
+}
+
+/** @brief Return whether bit `j` of a row is set. */
+bool bit(std::span<std::uint64_t const> row, std::size_t j) {
+  return ((row[j / 64] >> (j % 64)) & 1U) != 0;
+}
+
+} // namespace
+
+TEST_CASE("planted_partition: same options give the same data", "[planted_partition]") {
+  planted_partition_options const opts{.num_attributes = 150, .num_clusters = 7, .seed = 42};
+  planted_partition const a{opts};
+  planted_partition const b{opts};
+  CHECK(rows(a, 200) == rows(b, 200));
+  for (std::uint64_t i = 0; i < 200; ++i) {
+    CHECK(a.label(i) == b.label(i));
+  }
+
+  planted_partition const other{{.num_attributes = 150, .num_clusters = 7, .seed = 43}};
+  CHECK(rows(a, 200) != rows(other, 200));
+}
+
+TEST_CASE("planted_partition: a row does not depend on generation order", "[planted_partition]") {
+  planted_partition const model{{.num_attributes = 100, .num_clusters = 5}};
+  auto const forward = rows(model, 50);
+  std::vector<std::uint64_t> row(model.words_per_instance());
+  for (std::size_t i = 50; i-- > 0;) {
+    CHECK(model.generate(i, row) == model.label(i));
+    for (std::size_t w = 0; w < row.size(); ++w) {
+      CHECK(row[w] == forward[i * row.size() + w]);
+    }
+  }
+}
+
+TEST_CASE("planted_partition: padding bits are zero", "[planted_partition]") {
+  planted_partition const model{{.num_attributes = 70, .num_clusters = 3, .p_in = 1, .p_out = 1}};
+  REQUIRE(model.words_per_instance() == 2);
+  std::vector<std::uint64_t> row(2);
+  for (std::uint64_t i = 0; i < 100; ++i) {
+    (void)model.generate(i, row);
+    CHECK(row[0] == ~std::uint64_t{0});
+    CHECK(row[1] == (std::uint64_t{1} << 6) - 1);
+  }
+}
+
+TEST_CASE("planted_partition: noiseless extremes reproduce the prototypes exactly",
+          "[planted_partition]") {
+  planted_partition const model{
+      {.num_attributes = 130, .num_clusters = 4, .density = 0.3, .p_in = 1, .p_out = 0}};
+  std::vector<std::uint64_t> row(model.words_per_instance());
+  for (std::uint64_t i = 0; i < 200; ++i) {
+    std::size_t const c = model.generate(i, row);
+    for (std::size_t j = 0; j < model.num_attributes(); ++j) {
+      CHECK(bit(row, j) == (model.probability(c, j) == 1));
+    }
+  }
+}
+
+TEST_CASE("planted_partition: labels cover every cluster", "[planted_partition]") {
+  planted_partition const model{{.num_attributes = 8, .num_clusters = 10}};
+  std::vector<std::size_t> sizes(10);
+  for (std::uint64_t i = 0; i < 10000; ++i) {
+    std::size_t const label = model.label(i);
+    REQUIRE(label < 10);
+    ++sizes[label];
+  }
+  for (auto const size : sizes) {
+    CHECK(size > 800);
+    CHECK(size < 1200);
+  }
+}
+
+TEST_CASE("planted_partition: probabilities include noise and are rounded",
+          "[planted_partition]") {
+  planted_partition const model{{.num_attributes = 200,
+                                 .num_clusters = 3,
+                                 .density = 0.5,
+                                 .p_in = 0.9,
+                                 .p_out = 0.1,
+                                 .noise = 0.25}};
+  double const in = std::ldexp(std::round(std::ldexp(0.9 * 0.75 + 0.1 * 0.25, 16)), -16);
+  double const out = std::ldexp(std::round(std::ldexp(0.1 * 0.75 + 0.9 * 0.25, 16)), -16);
+  std::size_t characteristic = 0;
+  for (std::size_t c = 0; c < 3; ++c) {
+    for (std::size_t j = 0; j < 200; ++j) {
+      double const p = model.probability(c, j);
+      CHECK((p == in || p == out));
+      if (p == in) {
+        ++characteristic;
+      }
+    }
+  }
+  CHECK(characteristic > 240);
+  CHECK(characteristic < 360);
+}
+
+TEST_CASE("planted_partition: bits follow the cluster probabilities", "[planted_partition]") {
+  planted_partition const model{
+      {.num_attributes = 64, .num_clusters = 2, .density = 0.5, .p_in = 0.7, .p_out = 0.02}};
+  constexpr std::size_t n = 20000;
+  std::vector<std::uint64_t> row(1);
+  std::vector<std::size_t> members(2);
+  std::vector<std::size_t> set(2 * 64);
+  for (std::uint64_t i = 0; i < n; ++i) {
+    std::size_t const c = model.generate(i, row);
+    ++members[c];
+    for (std::size_t j = 0; j < 64; ++j) {
+      if (bit(row, j)) {
+        ++set[c * 64 + j];
+      }
+    }
+  }
+  for (std::size_t c = 0; c < 2; ++c) {
+    for (std::size_t j = 0; j < 64; ++j) {
+      double const p = model.probability(c, j);
+      double const observed =
+          static_cast<double>(set[c * 64 + j]) / static_cast<double>(members[c]);
+      // Five standard deviations of the binomial proportion.
+      CHECK(std::abs(observed - p) < 5 * std::sqrt(p * (1 - p) / static_cast<double>(members[c])));
+    }
+  }
+}
+
+TEST_CASE("planted_partition: invalid options throw", "[planted_partition]") {
+  CHECK_THROWS_AS(planted_partition({.num_attributes = 0}), std::logic_error);
+  CHECK_THROWS_AS(planted_partition({.num_clusters = 0}), std::logic_error);
+  CHECK_THROWS_AS(planted_partition({.density = 1.5}), std::logic_error);
+  CHECK_THROWS_AS(planted_partition({.p_in = -0.1}), std::logic_error);
+  CHECK_THROWS_AS(planted_partition({.p_out = 2}), std::logic_error);
+  CHECK_THROWS_AS(planted_partition({.noise = std::nan("")}), std::logic_error);
+}
@@ -1,7 +1,11 @@
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <list>
+#include <random>
 #include <set>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 
 #include <catch2/catch_test_macros.hpp>
@@ -9,6 +13,8 @@
 
 #include <popc/cluster.hpp>
 #include <popc/dataset.hpp>
+#include <popc/detail/power_table.hpp>
+#include <popc/partition.hpp>
 #include <popc/popc.hpp>
 
 using Catch::Matchers::WithinAbs;
@@ -38,6 +44,54 @@ std::list<popc::cluster> build_clusters(popc::dataset const &ds,
   return out;
 }
 
+// Planted-group data: instance i belongs to group i % num_groups, whose
+// attributes are the group_width-wide block starting at group *
+// group_width. Each bit is flipped with probability 1 / flip_one_in.
+popc::dataset planted_groups(std::size_t num_instances, std::size_t num_attributes,
+                             std::size_t num_groups, std::uint64_t rng_seed,
+                             std::size_t group_width = 3, std::uint64_t flip_one_in = 10) {
+  std::mt19937_64 rng{rng_seed};
+  std::vector<bool> data;
+  for (std::size_t i = 0; i < num_instances; ++i) {
+    std::size_t const group = i % num_groups;
+    for (std::size_t j = 0; j < num_attributes; ++j) {
+      bool const planted = j / group_width == group;
+      data.push_back(rng() % flip_one_in == 0 ? !planted : planted);
+    }
+  }
+  return popc::dataset{data, num_instances, num_attributes};
+}
+
+// Round-robin seed assignment of num_instances instances to k clusters.
+std::vector<std::size_t> round_robin(std::size_t num_instances, std::size_t k) {
+  std::vector<std::size_t> seed(num_instances);
+  for (std::size_t i = 0; i < num_instances; ++i) {
+    seed[i] = i % k;
+  }
+  return seed;
+}
+
+// True when some single move out of the partition has a positive gain
+// under exact compute_delta. Also checks that no cluster is empty.
+bool improvable(popc::dataset const &ds, std::list<popc::cluster> const &clusters,
+                double multiplier, double power) {
+  auto const n = clusters.size();
+  bool found = false;
+  for (auto const &src : clusters) {
+    CHECK_FALSE(src.empty());
+    for (auto const instance_num : src) {
+      auto const base = popc::compute_delta(ds, src, instance_num, n, multiplier, power, false);
+      for (auto const &dest : clusters) {
+        if (&dest != &src &&
+            base + popc::compute_delta(ds, dest, instance_num, n, multiplier, power, true) > 0) {
+          found = true;
+        }
+      }
+    }
+  }
+  return found;
+}
+
 } // namespace
 
 // ============================================================
@@ -97,6 +151,23 @@ TEST_CASE("compute_delta: adding to a heavily-populated cluster yields gain", "[
   CHECK(delta > 0.0);
 }
 
+TEST_CASE("compute_delta: table overload is bit-identical to std::pow", "[compute_delta]") {
+  std::istringstream in{"a\tb\tc\n1\t1\t0\n1\t0\t1\n0\t1\t1\n1\t1\t1\n"};
+  popc::dataset ds{in};
+  auto clusters = build_clusters(ds, {0, 0, 1, 1});
+  popc::detail::power_table<double> table{ds, 1000.0, 10.0};
+  table.set_num_clusters(clusters.size());
+
+  auto const &c0 = clusters.front();
+  auto const &c1 = clusters.back();
+  for (std::size_t i = 0; i < 2; ++i) {
+    CHECK(popc::compute_delta(ds, c0, i, table, false) ==
+          popc::compute_delta<double>(ds, c0, i, clusters.size(), 1000.0, 10.0, false));
+    CHECK(popc::compute_delta(ds, c1, i, table, true) ==
+          popc::compute_delta<double>(ds, c1, i, clusters.size(), 1000.0, 10.0, true));
+  }
+}
+
 // ============================================================
 // popc()
 // ============================================================
@@ -196,3 +267,373 @@ TEST_CASE("popc: float and double specializations agree on label structure", "[p
   CHECK(labels_f[0] == labels_f[1]);
   CHECK(labels_d[0] == labels_d[1]);
 }
+
+TEST_CASE("popc: pow and table engines produce identical assignments", "[popc]") {
+  // Duplicated and overlapping patterns, seeded one instance per cluster
+  // so that clusters drain and N changes repeatedly during the run.
+  std::istringstream in{"a\tb\tc\td\n"
+                        "1\t1\t0\t0\n1\t1\t0\t0\n1\t1\t1\t0\n0\t0\t1\t1\n"
+                        "0\t0\t1\t1\n0\t1\t1\t1\n1\t0\t0\t1\n1\t0\t0\t1\n"};
+  popc::dataset ds{in};
+  std::vector<std::size_t> const seed{0, 1, 2, 3, 4, 5, 6, 7};
+
+  for (double const power : {10.0, 3.5}) {
+    auto clusters_pow = build_clusters(ds, seed);
+    auto clusters_table = build_clusters(ds, seed);
+    auto const labels_pow = popc::popc(
+        ds, clusters_pow,
+        popc::options<double>{.power = power, .engine = popc::delta_engine::pow});
+    auto const labels_table = popc::popc(
+        ds, clusters_table,
+        popc::options<double>{.power = power, .engine = popc::delta_engine::table});
+    CHECK(labels_pow == labels_table);
+  }
+}
+
+TEST_CASE("popc: integer powers keep the engines identical", "[popc]") {
+  std::istringstream in{"a\tb\tc\td\n"
+                        "1\t1\t0\t0\n1\t1\t0\t0\n1\t1\t1\t0\n0\t0\t1\t1\n"
+                        "0\t0\t1\t1\n0\t1\t1\t1\n1\t0\t0\t1\n1\t0\t0\t1\n"};
+  popc::dataset ds{in};
+  std::vector<std::size_t> const seed{0, 1, 2, 3, 4, 5, 6, 7};
+
+  for (double const power : {10.0, 2.0, 17.0}) {
+    auto clusters_std = build_clusters(ds, seed);
+    auto const labels_std = popc::popc(ds, clusters_std, popc::options<double>{.power = power});
+    for (auto const engine : {popc::delta_engine::table, popc::delta_engine::pow}) {
+      auto clusters = build_clusters(ds, seed);
+      auto const labels = popc::popc(
+          ds, clusters,
+          popc::options<double>{.power = power, .engine = engine, .integer_power = true});
+      // No two moves here tie to within rounding, so squaring agrees with
+      // std::pow as well.
+      CHECK(labels == labels_std);
+    }
+  }
+
+  auto clusters = build_clusters(ds, seed);
+  CHECK_THROWS_AS(
+      popc::popc(ds, clusters, popc::options<double>{.power = 3.5, .integer_power = true}),
+      std::logic_error);
+}
+
+TEST_CASE("popc: partition and cluster-list overloads agree", "[popc]") {
+  std::istringstream in{"a\tb\tc\td\n"
+                        "1\t1\t0\t0\n1\t1\t0\t0\n1\t1\t1\t0\n0\t0\t1\t1\n"
+                        "0\t0\t1\t1\n0\t1\t1\t1\n1\t0\t0\t1\n1\t0\t0\t1\n"};
+  popc::dataset ds{in};
+  // Label 2 is unused, so both runs start with an empty seed cluster.
+  std::vector<std::size_t> const seed{0, 1, 3, 4, 5, 6, 7, 0};
+
+  for (auto const sweep : {popc::sweep_mode::sequential, popc::sweep_mode::batched}) {
+    popc::options<double> const opts{.sweep = sweep, .batch_size = 3};
+    auto clusters = build_clusters(ds, seed);
+    auto const from_list = popc::popc(ds, clusters, opts);
+    popc::partition part{ds, seed};
+    auto const from_partition = popc::popc(ds, part, opts);
+    CHECK(from_list == from_partition);
+
+    // The list holds the result, in label order.
+    REQUIRE(clusters.size() == part.num_clusters());
+    REQUIRE(part.num_slots() == part.num_clusters());
+    std::size_t slot = 0;
+    for (auto const &c : clusters) {
+      CHECK(std::vector<std::size_t>(c.begin(), c.end()) ==
+            std::vector<std::size_t>(part.members(slot).begin(), part.members(slot).end()));
+      for (auto const i : c) {
+        CHECK(from_list[i] == slot);
+      }
+      for (std::size_t j = 0; j < ds.num_attributes(); ++j) {
+        CHECK(c.attribute_count(j) == part.count(slot, j));
+      }
+      ++slot;
+    }
+  }
+}
+
+TEST_CASE("popc: threaded candidate scan reproduces the serial assignment", "[popc]") {
+  // 1200 singleton seeds drawn from a few prototypes: enough candidates
+  // for the scan to be split across threads, and many exact ties between
+  // identical clusters to exercise the tie-break.
+  constexpr std::size_t num_instances = 1200;
+  constexpr std::size_t num_attributes = 24;
+  std::mt19937_64 rng{2024};
+  std::vector<std::vector<bool>> prototypes(12, std::vector<bool>(num_attributes));
+  for (auto &proto : prototypes) {
+    for (std::size_t j = 0; j < num_attributes; ++j) {
+      proto[j] = rng() % 3 == 0;
+    }
+  }
+  std::vector<bool> data;
+  for (std::size_t i = 0; i < num_instances; ++i) {
+    auto const &proto = prototypes[rng() % prototypes.size()];
+    for (std::size_t j = 0; j < num_attributes; ++j) {
+      data.push_back(rng() % 16 == 0 ? !proto[j] : proto[j]);
+    }
+  }
+  popc::dataset const ds{data, num_instances, num_attributes};
+  std::vector<std::size_t> seed(num_instances);
+  for (std::size_t i = 0; i < num_instances; ++i) {
+    seed[i] = i;
+  }
+
+  for (auto const engine : {popc::delta_engine::table, popc::delta_engine::pow}) {
+    auto serial_clusters = build_clusters(ds, seed);
+    auto const serial = popc::popc(ds, serial_clusters,
+                                   popc::options<double>{.engine = engine, .num_threads = 1});
+    auto threaded_clusters = build_clusters(ds, seed);
+    auto const threaded = popc::popc(
+        ds, threaded_clusters, popc::options<double>{.engine = engine, .num_threads = 3});
+    CHECK(serial == threaded);
+  }
+}
+
+TEST_CASE("popc: attribute index pruning leaves the assignment unchanged", "[popc]") {
+  // Sparse instances over many attributes with singleton seeds: most
+  // clusters share no attribute with a given instance, so the pruned scan
+  // is taken, and the untouched clusters tie exactly.
+  constexpr std::size_t num_instances = 400;
+  constexpr std::size_t num_attributes = 200;
+  std::mt19937_64 rng{31};
+  std::vector<bool> data(num_instances * num_attributes);
+  for (std::size_t i = 0; i < num_instances; ++i) {
+    std::size_t const topic = i % 40;
+    for (std::size_t k = 0; k < 3; ++k) {
+      data[i * num_attributes + topic * 5 + rng() % 5] = true;
+    }
+    data[i * num_attributes + rng() % num_attributes] = true;
+  }
+  popc::dataset const ds{data, num_instances, num_attributes};
+  std::vector<std::size_t> seed(num_instances);
+  for (std::size_t i = 0; i < num_instances; ++i) {
+    seed[i] = i;
+  }
+
+  for (auto const engine : {popc::delta_engine::table, popc::delta_engine::pow}) {
+    for (auto const sweep : {popc::sweep_mode::sequential, popc::sweep_mode::batched}) {
+      for (std::size_t const num_threads : {1U, 3U}) {
+        INFO("threads = " << num_threads);
+        popc::options<double> opts{.engine = engine,
+                                   .num_threads = num_threads,
+                                   .sweep = sweep,
+                                   .batch_size = 64,
+                                   .attribute_index = false};
+        popc::partition plain{ds, seed};
+        auto const expected = popc::popc(ds, plain, opts);
+        CHECK_FALSE(plain.has_attribute_index());
+        opts.attribute_index = true;
+        popc::partition indexed{ds, seed};
+        CHECK(popc::popc(ds, indexed, opts) == expected);
+        CHECK(indexed.has_attribute_index());
+      }
+    }
+  }
+}
+
+TEST_CASE("popc: bound pruning skips candidates without changing the assignment",
+          "[popc]") {
+  // Planted groups seeded with many small clusters: once a large cluster
+  // matches an instance, the small ones cannot beat it.
+  auto const ds = planted_groups(600, 30, 6, /*rng_seed=*/5, /*group_width=*/5,
+                                 /*flip_one_in=*/12);
+  auto const seed = round_robin(ds.num_instances(), 150);
+
+  for (auto const engine : {popc::delta_engine::table, popc::delta_engine::pow}) {
+    for (auto const sweep : {popc::sweep_mode::sequential, popc::sweep_mode::batched}) {
+      for (double const power : {10.0, 2.0}) {
+        INFO("power = " << power);
+        popc::scan_stats plain_stats;
+        popc::options<double> opts{.power = power,
+                                   .engine = engine,
+                                   .sweep = sweep,
+                                   .batch_size = 50,
+                                   .attribute_index = false,
+                                   .bound_pruning = false,
+                                   .stats = &plain_stats};
+        popc::partition plain{ds, seed};
+        auto const expected = popc::popc(ds, plain, opts);
+        CHECK(plain_stats.evaluated + plain_stats.unchanged_skipped == plain_stats.candidates);
+        CHECK(plain_stats.bound_skipped == 0);
+
+        popc::scan_stats pruned_stats;
+        opts.bound_pruning = true;
+        opts.stats = &pruned_stats;
+        popc::partition pruned{ds, seed};
+        CHECK(popc::popc(ds, pruned, opts) == expected);
+        CHECK(pruned_stats.candidates == plain_stats.candidates);
+        CHECK(pruned_stats.evaluated + pruned_stats.bound_skipped +
+                  pruned_stats.unchanged_skipped ==
+              pruned_stats.candidates);
+        CHECK(pruned_stats.bound_skipped > 0);
+      }
+    }
+  }
+}
+
+TEST_CASE("popc: dirty tracking skips stable instances without changing the assignment",
+          "[popc]") {
+  // Forty sparse prototypes with little noise, seeded at random: the
+  // partition settles into many clusters and late sweeps move only a few
+  // instances.
+  constexpr std::size_t num_instances = 600;
+  constexpr std::size_t num_attributes = 120;
+  std::mt19937_64 rng{1};
+  std::vector<std::vector<bool>> prototypes(40, std::vector<bool>(num_attributes));
+  for (auto &proto : prototypes) {
+    for (std::size_t j = 0; j < num_attributes; ++j) {
+      proto[j] = rng() % 12 == 0;
+    }
+  }
+  std::vector<bool> data;
+  for (std::size_t i = 0; i < num_instances; ++i) {
+    auto const &proto = prototypes[rng() % prototypes.size()];
+    for (std::size_t j = 0; j < num_attributes; ++j) {
+      data.push_back(rng() % 200 == 0 ? !proto[j] : proto[j]);
+    }
+  }
+  popc::dataset const ds{data, num_instances, num_attributes};
+  std::vector<std::size_t> seed(num_instances);
+  for (auto &label : seed) {
+    label = rng() % 300;
+  }
+
+  for (auto const engine : {popc::delta_engine::table, popc::delta_engine::pow}) {
+    for (bool const bound_pruning : {false, true}) {
+      for (std::size_t const num_threads : {1U, 3U}) {
+        popc::scan_stats full_stats;
+        // Repeated squaring has the looser rounding bound; the pruning
+        // margins must cover it as well.
+        popc::options<double> opts{.engine = engine,
+                                   .integer_power = num_threads > 1,
+                                   .num_threads = num_threads,
+                                   .attribute_index = false,
+                                   .bound_pruning = bound_pruning,
+                                   .dirty_tracking = false,
+                                   .stats = &full_stats};
+        popc::partition full{ds, seed};
+        auto const expected = popc::popc(ds, full, opts);
+        CHECK(full_stats.unchanged_skipped == 0);
+
+        popc::scan_stats tracked_stats;
+        opts.dirty_tracking = true;
+        opts.stats = &tracked_stats;
+        popc::partition tracked{ds, seed};
+        CHECK(popc::popc(ds, tracked, opts) == expected);
+        CHECK(tracked_stats.candidates == full_stats.candidates);
+        CHECK(tracked_stats.unchanged_skipped > 0);
+        CHECK(tracked_stats.evaluated + tracked_stats.bound_skipped +
+                  tracked_stats.unchanged_skipped ==
+              tracked_stats.candidates);
+      }
+    }
+  }
+}
+
+TEST_CASE("popc: batched sweeps reach a local optimum independent of thread count",
+          "[popc]") {
+  auto const ds = planted_groups(300, 16, 5, /*rng_seed=*/77);
+  auto const seed = round_robin(ds.num_instances(), 40);
+
+  for (std::size_t const batch_size : {1U, 7U, 4096U}) {
+    INFO("batch_size = " << batch_size);
+    auto serial_clusters = build_clusters(ds, seed);
+    auto const serial = popc::popc(ds, serial_clusters,
+                                   popc::options<double>{.num_threads = 1,
+                                                         .sweep = popc::sweep_mode::batched,
+                                                         .batch_size = batch_size});
+    auto threaded_clusters = build_clusters(ds, seed);
+    auto const threaded = popc::popc(ds, threaded_clusters,
+                                     popc::options<double>{.num_threads = 3,
+                                                           .sweep = popc::sweep_mode::batched,
+                                                           .batch_size = batch_size});
+    CHECK(serial == threaded);
+
+    // No single move out of the final partition has a positive gain, and
+    // no cluster is left empty.
+    CHECK_FALSE(improvable(ds, serial_clusters, 1000.0, 10.0));
+  }
+}
+
+TEST_CASE("popc: approximate engine finishes at an exact local optimum", "[popc]") {
+  auto const ds = planted_groups(300, 16, 5, /*rng_seed=*/78);
+  auto const seed = round_robin(ds.num_instances(), 40);
+
+  for (auto const sweep : {popc::sweep_mode::sequential, popc::sweep_mode::batched}) {
+    for (double const power : {3.5, 10.0}) {
+      INFO("power = " << power);
+      auto clusters = build_clusters(ds, seed);
+      static_cast<void>(popc::popc(ds, clusters,
+                                   popc::options<double>{.power = power,
+                                                         .engine = popc::delta_engine::approx,
+                                                         .sweep = sweep,
+                                                         .batch_size = 16}));
+      CHECK_FALSE(improvable(ds, clusters, 1000.0, power));
+    }
+  }
+
+  auto clusters = build_clusters(ds, seed);
+  CHECK_THROWS_AS(popc::popc(ds, clusters,
+                             popc::options<double>{.multiplier = -1.0,
+                                                   .engine = popc::delta_engine::approx}),
+                  std::logic_error);
+  CHECK_THROWS_AS(popc::popc(ds, clusters,
+                             popc::options<double>{.power = -1.0,
+                                                   .engine = popc::delta_engine::approx}),
+                  std::logic_error);
+}
+
+TEST_CASE("popc: the observer reports every sweep", "[popc]") {
+  auto const ds = planted_groups(200, 12, 4, /*rng_seed=*/79);
+  auto const seed = round_robin(ds.num_instances(), 30);
+
+  for (auto const engine :
+       {popc::delta_engine::table, popc::delta_engine::pow, popc::delta_engine::approx}) {
+    for (auto const sweep : {popc::sweep_mode::sequential, popc::sweep_mode::batched}) {
+      std::vector<popc::sweep_report<double>> reports;
+      popc::scan_stats stats;
+      popc::partition part{ds, seed};
+      static_cast<void>(popc::popc(
+          ds, part,
+          popc::options<double>{.power = 3.5,
+                                .engine = engine,
+                                .sweep = sweep,
+                                .batch_size = 16,
+                                .stats = &stats,
+                                .observer = [&](popc::sweep_report<double> const &report) {
+                                  reports.push_back(report);
+                                }}));
+
+      REQUIRE(reports.size() >= 2);
+      popc::scan_stats summed;
+      for (std::size_t s = 0; s < reports.size(); ++s) {
+        CHECK(reports[s].sweep == s + 1);
+        summed.candidates += reports[s].scan.candidates;
+        summed.evaluated += reports[s].scan.evaluated;
+        summed.bound_skipped += reports[s].scan.bound_skipped;
+        summed.unchanged_skipped += reports[s].scan.unchanged_skipped;
+      }
+      CHECK(summed.candidates == stats.candidates);
+      CHECK(summed.evaluated == stats.evaluated);
+      CHECK(summed.bound_skipped == stats.bound_skipped);
+      CHECK(summed.unchanged_skipped == stats.unchanged_skipped);
+      CHECK(reports.front().moves > 0);
+      CHECK(reports.front().approximate == (engine == popc::delta_engine::approx));
+
+      // The last sweep found no move with exact terms, and its objective
+      // is that of the returned partition.
+      auto const &last = reports.back();
+      CHECK(last.moves == 0);
+      CHECK_FALSE(last.approximate);
+      CHECK(last.num_clusters == part.num_clusters());
+      double objective = 0;
+      for (std::size_t k = 0; k < part.num_clusters(); ++k) {
+        for (std::size_t j = 0; j < ds.num_attributes(); ++j) {
+          double const denom = static_cast<double>(ds.positive_count(j)) * 1000.0 +
+                               static_cast<double>(part.num_clusters());
+          objective += std::pow((static_cast<double>(part.count(k, j)) * 1000.0 + 1) / denom, 3.5);
+        }
+      }
+      CHECK_THAT(last.objective, WithinAbs(objective, 1e-9));
+    }
+  }
+}
@@ -0,0 +1,81 @@
+#include <cmath>
+#include <sstream>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <popc/dataset.hpp>
+#include <popc/detail/power_table.hpp>
+
+using popc::detail::power_table;
+
+TEST_CASE("power_table: rows span [0, positive_count]", "[power_table]") {
+  std::istringstream in{"a\tb\tc\n1\t0\t1\n1\t0\t0\n1\t0\t1\n"};
+  popc::dataset ds{in};
+  power_table<double> table{ds, 1000.0, 10.0};
+  table.set_num_clusters(2);
+
+  CHECK(table.row(0).size() == 4);
+  CHECK(table.row(1).size() == 1);
+  CHECK(table.row(2).size() == 3);
+}
+
+TEST_CASE("power_table: entries equal std::pow of the probability", "[power_table]") {
+  std::istringstream in{"a\tb\n1\t1\n1\t0\n1\t1\n0\t1\n"};
+  popc::dataset ds{in};
+  power_table<double> table{ds, 37.5, 3.5};
+  table.set_num_clusters(3);
+
+  for (std::size_t j = 0; j < ds.num_attributes(); ++j) {
+    auto const row = table.row(j);
+    double const denom = static_cast<double>(ds.positive_count(j)) * 37.5 + 3.0;
+    for (std::size_t c = 0; c < row.size(); ++c) {
+      // Exact equality: the table must be bit-identical to the pow path.
+      CHECK(row[c] == std::pow((static_cast<double>(c) * 37.5 + 1) / denom, 3.5));
+    }
+  }
+}
+
+TEST_CASE("power_table: rows are refreshed when the cluster count changes", "[power_table]") {
+  std::istringstream in{"a\n1\n1\n"};
+  popc::dataset ds{in};
+  power_table<double> table{ds, 1000.0, 10.0};
+
+  table.set_num_clusters(2);
+  double const at_two = table.row(0)[0];
+  table.set_num_clusters(1);
+  double const at_one = table.row(0)[0];
+
+  CHECK(at_two == std::pow(1.0 / 2002.0, 10.0));
+  CHECK(at_one == std::pow(1.0 / 2001.0, 10.0));
+  CHECK(table.num_clusters() == 1);
+}
+
+TEST_CASE("power_table: integral rows are filled by repeated squaring", "[power_table]") {
+  std::istringstream in{"a\tb\n1\t1\n1\t0\n1\t1\n0\t1\n"};
+  popc::dataset ds{in};
+  power_table<double> table{ds, 1000.0, 10.0, true};
+  table.set_num_clusters(3);
+
+  CHECK(table.raise().integral());
+  for (std::size_t j = 0; j < ds.num_attributes(); ++j) {
+    auto const row = table.row(j);
+    double const denom = static_cast<double>(ds.positive_count(j)) * 1000.0 + 3.0;
+    for (std::size_t c = 0; c < row.size(); ++c) {
+      CHECK(row[c] == popc::detail::integer_pow((static_cast<double>(c) * 1000.0 + 1) / denom, 10));
+    }
+  }
+}
+
+TEST_CASE("power_table: changing the power function refreshes every row", "[power_table]") {
+  std::istringstream in{"a\n1\n1\n"};
+  popc::dataset ds{in};
+  power_table<double> table{ds, 1000.0,
+                            popc::detail::power_function<double>{popc::detail::approximate_power,
+                                                                 3.5}};
+  table.set_num_clusters(2);
+  CHECK(table.row(0)[0] == popc::detail::approx_pow(1.0 / 2002.0, 3.5));
+
+  table.set_raise(popc::detail::power_function<double>{3.5});
+  CHECK(table.row(0)[0] == std::pow(1.0 / 2002.0, 3.5));
+  CHECK_FALSE(table.raise().approximate());
+}
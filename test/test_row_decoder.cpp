@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <popc/detail/row_decoder.hpp>
+
+using popc::detail::compress_even_bits;
+using popc::detail::decode_chunks_fn;
+using popc::detail::decode_row;
+
+namespace {
+
+// Render `bits` as a well-formed delimited row terminated by '\n'.
+std::string render_row(std::vector<bool> const &bits, char delimiter) {
+  std::string row;
+  for (std::size_t j = 0; j < bits.size(); ++j) {
+    row += bits[j] ? '1' : '0';
+    row += j + 1 == bits.size() ? '\n' : delimiter;
+  }
+  return row;
+}
+
+std::vector<decode_chunks_fn> available_kernels() {
+  std::vector<decode_chunks_fn> kernels{popc::detail::decode_chunks_scalar};
+#ifdef POPC_ROW_DECODER_X86
+  kernels.push_back(popc::detail::decode_chunks_sse2);
+  if (__builtin_cpu_supports("avx2")) {
+    kernels.push_back(popc::detail::decode_chunks_avx2);
+  }
+#endif
+  return kernels;
+}
+
+} // namespace
+
+TEST_CASE("compress_even_bits: gathers even bits in order", "[row_decoder]") {
+  CHECK(compress_even_bits(0) == 0U);
+  CHECK(compress_even_bits(0x5555555555555555ULL) == 0xFFFFFFFFU);
+  CHECK(compress_even_bits(0xAAAAAAAAAAAAAAAAULL) == 0U);
+  CHECK(compress_even_bits(0b0100'0001ULL) == 0b1001U);
+  CHECK(compress_even_bits(std::uint64_t{1} << 62U) == (1U << 31U));
+}
+
+TEST_CASE("decode_chunks: every kernel packs and validates identically", "[row_decoder]") {
+  std::mt19937_64 rng{99};
+  std::vector<bool> bits(128);
+  for (auto &&b : bits) {
+    b = (rng() & 1U) != 0U;
+  }
+  std::string const row = render_row(bits, ',');
+  for (auto const kernel : available_kernels()) {
+    std::vector<std::uint64_t> words(2, 0);
+    // Four full chunks cover all 128 attributes' value/delimiter pairs
+    // except the final newline, which is outside the kernel's contract,
+    // so decode three and check them.
+    REQUIRE(kernel(row.data(), 3, ',', words.data()));
+    for (std::size_t j = 0; j < 96; ++j) {
+      CHECK(((words[j / 64] >> (j % 64)) & 1U) == static_cast<std::uint64_t>(bits[j]));
+    }
+    for (std::size_t j = 96; j < 128; ++j) {
+      CHECK(((words[j / 64] >> (j % 64)) & 1U) == 0U);
+    }
+
+    std::string bad = row;
+    bad[2 * 40 + 1] = ';'; // wrong delimiter in the second chunk
+    std::vector<std::uint64_t> scratch(2, 0);
+    CHECK_FALSE(kernel(bad.data(), 3, ',', scratch.data()));
+    bad = row;
+    bad[2 * 70] = '2'; // invalid value in the third chunk
+    CHECK_FALSE(kernel(bad.data(), 3, ',', scratch.data()));
+  }
+}
+
+TEST_CASE("decode_row: handles chunk tails and the terminating newline", "[row_decoder]") {
+  for (std::size_t const f : {1U, 2U, 31U, 32U, 33U, 64U, 65U, 100U}) {
+    std::vector<bool> bits(f);
+    for (std::size_t j = 0; j < f; ++j) {
+      bits[j] = j % 5 == 1 || j + 1 == f;
+    }
+    std::string const row = render_row(bits, '\t');
+    std::vector<std::uint64_t> words((f + 63) / 64, 0);
+    INFO("num_attributes = " << f);
+    REQUIRE(decode_row(row.data(), f, '\t', words.data()));
+    for (std::size_t j = 0; j < f; ++j) {
+      CHECK(((words[j / 64] >> (j % 64)) & 1U) == static_cast<std::uint64_t>(bits[j]));
+    }
+
+    std::string missing_newline = row;
+    missing_newline.back() = '\t';
+    std::vector<std::uint64_t> scratch(words.size(), 0);
+    CHECK_FALSE(decode_row(missing_newline.data(), f, '\t', scratch.data()));
+  }
+}
@@ -0,0 +1,54 @@
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <popc/detail/thread_pool.hpp>
+
+using popc::detail::thread_pool;
+
+TEST_CASE("thread_pool: rejects a zero-sized pool", "[thread_pool]") {
+  CHECK_THROWS_AS(thread_pool{0}, std::logic_error);
+}
+
+TEST_CASE("thread_pool: runs every task exactly once", "[thread_pool]") {
+  for (std::size_t const threads : {1U, 2U, 4U}) {
+    thread_pool pool{threads};
+    CHECK(pool.size() == threads);
+    // Reuse the same pool across loops of varying size, including empty.
+    for (std::size_t const tasks : {0U, 1U, 3U, 1000U}) {
+      std::vector<std::atomic<int>> hits(tasks);
+      pool.for_each(tasks, [&](std::size_t k) { hits[k].fetch_add(1); });
+      for (auto const &h : hits) {
+        CHECK(h.load() == 1);
+      }
+    }
+  }
+}
+
+TEST_CASE("thread_pool: single thread runs tasks inline in order", "[thread_pool]") {
+  thread_pool pool{1};
+  std::vector<std::size_t> order;
+  pool.for_each(5, [&](std::size_t k) { order.push_back(k); });
+  CHECK(order == std::vector<std::size_t>{0, 1, 2, 3, 4});
+}
+
+TEST_CASE("thread_pool: rethrows a task exception after the loop", "[thread_pool]") {
+  thread_pool pool{3};
+  std::atomic<int> ran{0};
+  CHECK_THROWS_AS(pool.for_each(64,
+                                [&](std::size_t k) {
+                                  ran.fetch_add(1);
+                                  if (k == 7) {
+                                    throw std::runtime_error{"task failed"};
+                                  }
+                                }),
+                  std::runtime_error);
+  CHECK(ran.load() == 64);
+  // The pool stays usable after a failed loop.
+  std::atomic<int> again{0};
+  pool.for_each(8, [&](std::size_t) { again.fetch_add(1); });
+  CHECK(again.load() == 8);
+}
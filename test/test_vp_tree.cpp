@@ -0,0 +1,166 @@
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <popc/detail/hamming.hpp>
+#include <popc/detail/planted_partition.hpp>
+#include <popc/detail/vp_tree.hpp>
+
+using popc::detail::hamming_distance;
+using popc::detail::vp_tree;
+
+namespace {
+
+/** @brief Nearest of `ids` to `query` by a linear scan, keeping the first strict improvement. */
+vp_tree::neighbor brute_force(std::span<std::uint64_t const> points, std::size_t wpi,
+                              std::span<std::size_t const> ids,
+                              std::span<std::uint64_t const> query) {
+  vp_tree::neighbor best;
+  for (auto const id : ids) {
+    std::size_t const d = hamming_distance(query, points.subspan(id * wpi, wpi));
+    if (d < best.distance || (d == best.distance && id < best.id)) {
+      best = {id, d};
+    }
+  }
+  return best;
+}
+
+/** @brief Nearest of `ids` other than `excluded`, by the same scan. */
+vp_tree::neighbor brute_force_second(std::span<std::uint64_t const> points, std::size_t wpi,
+                                     std::span<std::size_t const> ids,
+                                     std::span<std::uint64_t const> query, std::size_t excluded) {
+  std::vector<std::size_t> others;
+  for (auto const id : ids) {
+    if (id != excluded) {
+      others.push_back(id);
+    }
+  }
+  return brute_force(points, wpi, others, query);
+}
+
+/** @brief Check every query against the brute-force answers. */
+void check_queries(vp_tree const &tree, std::span<std::uint64_t const> points, std::size_t wpi,
+                   std::span<std::size_t const> ids, std::span<std::uint64_t const> queries) {
+  for (std::size_t q = 0; q < queries.size() / wpi; ++q) {
+    auto const query = queries.subspan(q * wpi, wpi);
+    auto const expected = brute_force(points, wpi, ids, query);
+    auto const found = tree.nearest(query);
+    CHECK(found.id == expected.id);
+    CHECK(found.distance == expected.distance);
+
+    auto const [first, second] = tree.nearest_two(query);
+    auto const expected_second = brute_force_second(points, wpi, ids, query, expected.id);
+    CHECK(first.id == expected.id);
+    CHECK(first.distance == expected.distance);
+    CHECK(second.id == expected_second.id);
+    CHECK(second.distance == expected_second.distance);
+  }
+}
+
+/** @brief `n` rows drawn from a planted partition. */
+std::vector<std::uint64_t> planted_rows(std::size_t n, std::size_t num_attributes,
+                                        std::uint64_t seed) {
+  popc::detail::planted_partition const model{
+      {.num_attributes = num_attributes, .num_clusters = 8, .density = 0.3, .seed = seed}};
+  std::size_t const wpi = model.words_per_instance();
+  std::vector<std::uint64_t> out(n * wpi);
+  for (std::size_t i = 0; i < n; ++i) {
+    (void)model.generate(i, std::span{out.data() + i * wpi, wpi});
+  }
+  return out;
+}
+
+} // namespace
+
+TEST_CASE("vp_tree: an empty tree finds nothing", "[vp_tree]") {
+  vp_tree tree;
+  CHECK(tree.size() == 0);
+  std::vector<std::uint64_t> const query{0};
+  CHECK(tree.nearest(query).id == vp_tree::neighbor{}.id);
+
+  tree.build({}, 1, {});
+  CHECK(tree.nearest(query).distance == vp_tree::neighbor{}.distance);
+  CHECK(tree.nearest_two(query).second.id == vp_tree::neighbor{}.id);
+}
+
+TEST_CASE("vp_tree: nearest matches a linear scan on random rows", "[vp_tree]") {
+  std::mt19937_64 rng{7};
+  for (std::size_t const wpi : {std::size_t{1}, std::size_t{3}}) {
+    for (std::size_t const k : {std::size_t{1}, std::size_t{5}, std::size_t{9}, std::size_t{200}}) {
+      std::vector<std::uint64_t> points(k * wpi);
+      for (auto &w : points) {
+        w = rng() & rng();
+      }
+      std::vector<std::size_t> ids(k);
+      std::iota(ids.begin(), ids.end(), 0);
+      vp_tree tree;
+      tree.build(points, wpi, ids);
+      REQUIRE(tree.size() == k);
+
+      std::vector<std::uint64_t> queries(50 * wpi);
+      for (auto &w : queries) {
+        w = rng() & rng();
+      }
+      check_queries(tree, points, wpi, ids, queries);
+      // Every indexed point is its own nearest neighbour.
+      check_queries(tree, points, wpi, ids, points);
+    }
+  }
+}
+
+TEST_CASE("vp_tree: duplicate points resolve to the lowest identifier", "[vp_tree]") {
+  // Three distinct rows, each repeated; ids are given out of order.
+  std::vector<std::uint64_t> points;
+  for (std::size_t copy = 0; copy < 20; ++copy) {
+    points.insert(points.end(), {0x0FULL, 0xF0ULL, 0xFF00ULL});
+  }
+  std::vector<std::size_t> ids(points.size());
+  std::iota(ids.rbegin(), ids.rend(), 0);
+  vp_tree tree;
+  tree.build(points, 1, ids);
+
+  CHECK(tree.nearest(std::vector<std::uint64_t>{0x0F}).id == 0);
+  CHECK(tree.nearest(std::vector<std::uint64_t>{0xF0}).id == 1);
+  CHECK(tree.nearest(std::vector<std::uint64_t>{0xFF00}).id == 2);
+  // Equidistant from rows 0 and 1; row 0 has the lower identifier.
+  auto const tie = tree.nearest(std::vector<std::uint64_t>{0x00});
+  CHECK(tie.id == 0);
+  CHECK(tie.distance == 4);
+  // The second nearest is the next copy of row 0, not row 1.
+  CHECK(tree.nearest_two(std::vector<std::uint64_t>{0x0F}).second.id == 3);
+  check_queries(tree, points, 1, ids, std::vector<std::uint64_t>{0x1, 0x11, 0x3C, 0xFFFF, 0});
+}
+
+TEST_CASE("vp_tree: a subset of the points is indexed", "[vp_tree]") {
+  std::size_t const num_attributes = 150;
+  std::size_t const wpi = (num_attributes + 63) / 64;
+  auto const points = planted_rows(400, num_attributes, 3);
+  std::vector<std::size_t> ids;
+  for (std::size_t i = 0; i < 400; i += 3) {
+    ids.push_back(i);
+  }
+  vp_tree tree;
+  tree.build(points, wpi, ids);
+  CHECK(tree.size() == ids.size());
+  // Queries include the unindexed rows, whose nearest indexed row is another.
+  check_queries(tree, points, wpi, ids, points);
+}
+
+TEST_CASE("vp_tree: rebuilding replaces the indexed points", "[vp_tree]") {
+  std::size_t const wpi = 2;
+  auto const first = planted_rows(300, 128, 5);
+  auto const second = planted_rows(100, 128, 6);
+  std::vector<std::size_t> ids(300);
+  std::iota(ids.begin(), ids.end(), 0);
+  vp_tree tree;
+  tree.build(first, wpi, ids);
+  ids.resize(100);
+  tree.build(second, wpi, ids);
+  CHECK(tree.size() == 100);
+  check_queries(tree, second, wpi, ids, first);
+}